@@ -0,0 +1,337 @@
+// pong_bench: times the game's hot paths and compares them to bench/baseline.json.
+//
+//     pong_bench                               run everything, compare to the baseline
+//     pong_bench --filter=Shader               only benchmarks with "Shader" in the name
+//     pong_bench --write-baseline=bench/baseline.json
+//     pong_bench --tolerance=0.10 --samples=50
+//
+// Each benchmark is warmed up, then timed in samples of enough iterations to take about a millisecond.
+// The median ns/op is what gets compared; a benchmark regresses when it's more than tolerance slower
+// than its baseline, and the exit code is 1 if anything regressed. Baselines only mean something on the
+// machine that wrote them, so regenerate it when the reference machine changes.
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/gameClock.h"
+#include "../src/pongPhysics.h"
+#include "../src/pongWorld.h"
+#include "../src/shapes.h"
+#include "../src/shaderSources.h"
+#include "../src/sdfFont.h"
+
+static volatile float benchSink = 0.0f;
+
+// keeps the compiler from throwing away a result we never use
+inline void doNotOptimize(float value) {
+    benchSink = benchSink + value;
+}
+
+struct benchResult {
+    std::string name;
+    double minimum = 0.0;
+    double median = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+    double p95 = 0.0;
+};
+
+struct benchOptions {
+    std::string baselinePath = "bench/baseline.json";
+    std::string writeBaselinePath;
+    std::string filter;
+    double tolerance = -1.0; // < 0 = use the one in the baseline file
+    int samples = 30;
+    uint64_t warmupNanoseconds = 100000000;   // 100 ms
+    uint64_t sampleNanoseconds = 1000000;     // 1 ms
+};
+
+class benchRunner {
+public:
+    benchOptions options;
+    std::vector<benchResult> results;
+
+    template <typename Op>
+    void run(const char* name, Op op) {
+        if (!options.filter.empty() && std::string(name).find(options.filter) == std::string::npos)
+            return;
+
+        // warmup, and find out how many iterations fill one sample
+        uint64_t iterations = 1;
+        uint64_t warmupEnd = nowNanoseconds() + options.warmupNanoseconds;
+        while (true) {
+            uint64_t start = nowNanoseconds();
+            for (uint64_t i = 0; i < iterations; i++)
+                op();
+            uint64_t elapsed = nowNanoseconds() - start;
+
+            if (elapsed < options.sampleNanoseconds)
+                iterations *= 2;
+            else if (nowNanoseconds() >= warmupEnd)
+                break;
+        }
+
+        std::vector<double> perOp(options.samples);
+        for (int s = 0; s < options.samples; s++) {
+            uint64_t start = nowNanoseconds();
+            for (uint64_t i = 0; i < iterations; i++)
+                op();
+            perOp[s] = static_cast<double>(nowNanoseconds() - start) / iterations;
+        }
+
+        std::sort(perOp.begin(), perOp.end());
+        benchResult result;
+        result.name = name;
+        result.minimum = perOp.front();
+        result.median = perOp[perOp.size() / 2];
+        result.p95 = perOp[std::min(perOp.size() - 1, static_cast<size_t>(perOp.size() * 0.95))];
+        for (double value : perOp)
+            result.mean += value;
+        result.mean /= perOp.size();
+        for (double value : perOp)
+            result.stddev += (value - result.mean) * (value - result.mean);
+        result.stddev = std::sqrt(result.stddev / perOp.size());
+
+        results.push_back(result);
+        std::cout << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(2)
+            << " median " << std::setw(10) << result.median << " ns"
+            << "  min " << std::setw(10) << result.minimum
+            << "  p95 " << std::setw(10) << result.p95
+            << "  stddev " << std::setw(8) << result.stddev
+            << "  (" << iterations << " x " << options.samples << ")" << std::endl;
+    }
+};
+
+// just enough JSON for the baseline file: {"tolerance": x, "benchmarks": {"name": ns, ...}}
+static bool readBaseline(const std::string& path, std::map<std::string, double>& baseline, double& tolerance) {
+    std::ifstream in(path);
+    if (!in)
+        return false;
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    std::string text = buffer.str();
+
+    size_t pos = 0;
+    while ((pos = text.find('"', pos)) != std::string::npos) {
+        size_t end = text.find('"', pos + 1);
+        if (end == std::string::npos)
+            break;
+        std::string key = text.substr(pos + 1, end - pos - 1);
+
+        size_t colon = text.find_first_not_of(" \t\r\n", end + 1);
+        if (colon == std::string::npos || text[colon] != ':') {
+            pos = end + 1;
+            continue;
+        }
+        const char* number = text.c_str() + text.find_first_not_of(" \t\r\n", colon + 1);
+        char* numberEnd = nullptr;
+        double value = std::strtod(number, &numberEnd);
+        if (numberEnd != number) {
+            if (key == "tolerance")
+                tolerance = value;
+            else
+                baseline[key] = value;
+        }
+        pos = end + 1;
+    }
+    return true;
+}
+
+static bool writeBaseline(const std::string& path, const std::vector<benchResult>& results, double tolerance) {
+    std::ofstream out(path);
+    if (!out)
+        return false;
+    out << "{\n  \"tolerance\": " << tolerance << ",\n  \"benchmarks\": {\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        out << "    \"" << results[i].name << "\": " << std::fixed << std::setprecision(2) << results[i].median
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  }\n}\n";
+    return true;
+}
+
+static void parseArgs(int argc, char** argv, benchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto value = [&](const char* name, std::string& out) {
+            std::string prefix = std::string(name) + "=";
+            if (arg.compare(0, prefix.size(), prefix) != 0)
+                return false;
+            out = arg.substr(prefix.size());
+            return true;
+        };
+
+        std::string text;
+        if (value("--baseline", text))
+            options.baselinePath = text;
+        else if (value("--write-baseline", text))
+            options.writeBaselinePath = text;
+        else if (value("--filter", text))
+            options.filter = text;
+        else if (value("--tolerance", text))
+            options.tolerance = std::atof(text.c_str());
+        else if (value("--samples", text))
+            options.samples = std::max(1, std::atoi(text.c_str()));
+        else
+            std::cout << "Unknown option: " << arg << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    benchRunner bench;
+    parseArgs(argc, argv, bench.options);
+
+    // the right paddle and the ball as spawnArena places them, and a spread of ball positions around the paddle
+    // that hits it about a third of the time
+    const glm::vec3 paddle = arenaRightPaddle;
+    const glm::vec3 paddleScale = arenaPaddleScale;
+    const glm::vec3 ballScale = arenaBallScale;
+    std::vector<glm::vec3> balls(1024);
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<float> spread(-0.4f, 0.4f);
+    for (glm::vec3& ball : balls)
+        ball = paddle + glm::vec3(spread(gen), 0.0f, spread(gen));
+    size_t next = 0;
+
+    bench.run("cubesOverlap", [&] {
+        const glm::vec3& ball = balls[next++ & 1023];
+        doNotOptimize(cubesOverlap(ball, ballScale, paddle, paddleScale) ? 1.0f : 0.0f);
+    });
+
+    bench.run("paddleBounce", [&] {
+        const glm::vec3& ball = balls[next++ & 1023];
+        float speedX = 1.0f, speedZ = 0.5f;
+        bool hasBouncedX = false, hasBouncedZ = false;
+        paddleBounce(ball, ballScale, paddle, paddleScale, speedX > 0, speedX, speedZ, hasBouncedX, hasBouncedZ);
+        doNotOptimize(speedX + speedZ);
+    });
+
+    bench.run("resetCube", [&] {
+        float speedX = 0.0f, speedZ = 0.0f;
+        serveSpeeds(gen, speedX, speedZ);
+        doNotOptimize(speedX + speedZ);
+    });
+
+    bench.run("randomFloat", [&] {
+        doNotOptimize(randomFloat(gen, -2.0f, 2.0f));
+    });
+
+    bench.run("cubeModelMatrix", [&] {
+        const glm::vec3& ball = balls[next++ & 1023];
+        glm::mat4 model = cubeModelMatrix(paddle, ball, ballScale, 0.5f);
+        doNotOptimize(model[3][0] + model[0][0]);
+    });
+
+    // a simulation step's systems over the arena and --sandbox=100000, on this thread and then over the job system
+    static jobSystem jobs; // static, its deques are too big for the stack
+    ecsWorld world;
+    spawnArena(world);
+    spawnSandboxBalls(world, 100000);
+    systemScratch scratch;
+    std::vector<renderInstance> instances[modelCount];
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            int spareCores = static_cast<int>(std::thread::hardware_concurrency()) - 1;
+            jobs.start(spareCores > 0 ? spareCores : 0);
+        }
+        std::string suffix = pass == 0 ? "" : "Jobs";
+        bench.run(("movementSystem100k" + suffix).c_str(), [&] {
+            savePositionSystem(world, jobs, scratch);
+            movementSystem(world, jobs, scratch, 1.0f / 240.0f);
+            doNotOptimize(world.get<transform>(entity{ 10, 0 })->position.x);
+        });
+
+        bench.run(("bounceSystem100k" + suffix).c_str(), [&] {
+            bounceSystem(world, jobs, scratch);
+            doNotOptimize(world.get<velocity>(entity{ 10, 0 })->value.x);
+        });
+
+        bench.run(("renderExtraction100k" + suffix).c_str(), [&] {
+            renderExtractionSystem(world, jobs, scratch, instances);
+            doNotOptimize(instances[modelBall].back().position.x);
+        });
+    }
+    jobs.stop();
+
+    verticesAndIndicesForShapes shapes;
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    bench.run("PositionsForCube", [&] {
+        shapes.PositionsForCube(vertices, indices, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f);
+        doNotOptimize(vertices[0]);
+    });
+
+    bench.run("createVertexShaderSource", [&] {
+        doNotOptimize(static_cast<float>(buildVertexShaderSource(true).size()));
+    });
+
+    bench.run("createFragmentShaderSource", [&] {
+        doNotOptimize(static_cast<float>(buildTexturedFragmentShaderSource(0.8f, 0.2f, 0.2f, 1.0f).size()));
+    });
+
+    // what the HUD does when a score changes: lay out both scores as SDF quads. Run from the repo root for the font.
+    sdfFont font;
+    if (font.loadFile("fonts/VCR_OSD_MONO_1.001.ttf")) {
+        sdfVertex quads[2 * 15 * 6];
+        int score = 0;
+        bench.run("scoreTextLayout", [&] {
+            char text[16];
+            snprintf(text, sizeof(text), "%d", score % 10);
+            int count = font.layout(text, 760.0f - font.textWidth(text, 120.0f) * 0.5f, 150.0f, 120.0f, 0xFF00FFFF, quads, 90);
+            snprintf(text, sizeof(text), "%d", (score / 10) % 10);
+            count += font.layout(text, 1160.0f - font.textWidth(text, 120.0f) * 0.5f, 150.0f, 120.0f, 0xFF00FFFF, quads + count, 90);
+            score++;
+            doNotOptimize(quads[count - 1].x);
+        });
+    } else {
+        std::cout << "Skipping scoreTextLayout, fonts/VCR_OSD_MONO_1.001.ttf not found" << std::endl;
+    }
+
+    if (!bench.options.writeBaselinePath.empty()) {
+        double tolerance = bench.options.tolerance >= 0.0 ? bench.options.tolerance : 0.25;
+        if (!writeBaseline(bench.options.writeBaselinePath, bench.results, tolerance)) {
+            std::cout << "Couldn't write " << bench.options.writeBaselinePath << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote baseline to " << bench.options.writeBaselinePath << std::endl;
+        return 0;
+    }
+
+    std::map<std::string, double> baseline;
+    double tolerance = 0.25;
+    if (!readBaseline(bench.options.baselinePath, baseline, tolerance)) {
+        std::cout << "No baseline at " << bench.options.baselinePath << ", nothing to compare against" << std::endl;
+        return 0;
+    }
+    if (bench.options.tolerance >= 0.0)
+        tolerance = bench.options.tolerance;
+
+    int regressions = 0;
+    std::cout << "\nCompared to " << bench.options.baselinePath << " (tolerance " << tolerance * 100.0 << "%)" << std::endl;
+    for (const benchResult& result : bench.results) {
+        auto found = baseline.find(result.name);
+        if (found == baseline.end()) {
+            std::cout << "  " << std::left << std::setw(28) << result.name << " new, not in baseline" << std::endl;
+            continue;
+        }
+        double change = found->second > 0.0 ? result.median / found->second - 1.0 : 0.0;
+        bool regressed = change > tolerance;
+        regressions += regressed ? 1 : 0;
+        std::cout << "  " << std::left << std::setw(28) << result.name << std::right << std::showpos << std::setw(8)
+            << change * 100.0 << "%" << std::noshowpos << (regressed ? "  REGRESSION" : "") << std::endl;
+    }
+
+    if (regressions > 0) {
+        std::cout << regressions << " benchmark(s) regressed" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include "allocationTracker.h"
+
+// Proves the gameplay loop doesn't touch the heap. In builds with PONG_ALLOCATION_CHECK defined (it is in the Debug
+// configurations) allocationTracker sees every operator new, and with --allocation-check every gameplay frame that
+// allocated anything is reported once the game has settled in:
+//
+//     Frame 1234 allocated 2 times (96 bytes) during gameplay
+//
+// The count covers every thread, so the simulation thread and the job workers are held to it too, and ImGui and
+// miniaudio allocate through the tracker as well. GLFW's mallocs aren't counted, and the frame tools (--capture,
+// --dump-frames) allocate by design. --allocation-stats says which subsystem the allocations came from.
+
+class allocationCheck {
+public:
+    static const int settleFrames = 120;  // gameplay frames before counting, the first serve and sounds warm up
+    static const int framesReported = 10; // printed one by one, the rest only go into the totals
+
+    bool enabled = false;
+    uint64_t frameIndex = 0;
+    uint64_t allocationsBefore = 0;
+    uint64_t bytesBefore = 0;
+    int settledFor = 0;
+
+    uint64_t framesChecked = 0;
+    uint64_t allocatingFrames = 0;
+    uint64_t mostAllocations = 0;
+
+    void init(bool enabled) {
+#ifdef PONG_ALLOCATION_CHECK
+        this->enabled = enabled;
+#else
+        if (enabled)
+            std::cout << "--allocation-check needs a build with PONG_ALLOCATION_CHECK defined" << std::endl;
+#endif
+    }
+
+    // top of the loop
+    void beginFrame() {
+        if (!enabled)
+            return;
+        allocationTracker::totals now = allocationTracker::total();
+        allocationsBefore = now.allocations;
+        bytesBefore = now.bytes;
+    }
+
+    // after the swap. gameplay is false on the menus and while startup or texture streaming is still going.
+    void endFrame(bool gameplay) {
+        if (!enabled)
+            return;
+        frameIndex++;
+        allocationTracker::totals now = allocationTracker::total();
+        uint64_t allocations = now.allocations - allocationsBefore;
+        uint64_t bytes = now.bytes - bytesBefore;
+        if (!gameplay) {
+            settledFor = 0;
+            return;
+        }
+        if (settledFor < settleFrames) {
+            settledFor++;
+            return;
+        }
+
+        framesChecked++;
+        if (allocations == 0)
+            return;
+        if (allocatingFrames < framesReported)
+            std::cout << "Frame " << frameIndex << " allocated " << allocations << " times (" << bytes
+                << " bytes) during gameplay" << std::endl;
+        allocatingFrames++;
+        if (allocations > mostAllocations)
+            mostAllocations = allocations;
+    }
+
+    // false when a settled gameplay frame allocated
+    bool shutdown() {
+        if (!enabled)
+            return true;
+        std::cout << "Allocation check: " << framesChecked << " gameplay frames checked, " << allocatingFrames
+            << " allocated";
+        if (allocatingFrames > 0)
+            std::cout << ", " << mostAllocations << " times at most";
+        std::cout << std::endl;
+        return allocatingFrames == 0;
+    }
+};
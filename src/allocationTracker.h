@@ -0,0 +1,532 @@
+#pragma once
+// Who allocates, how much and how often, per frame. In builds with PONG_ALLOCATION_CHECK defined (the Debug
+// configurations) global operator new and delete are replaced, and ImGui and miniaudio are given allocators that
+// go through the same place. Each allocation is charged to the subsystem the thread is in at the time:
+//
+//     ALLOCATION_SCOPE(allocationAudio);   // until the end of the block, innermost wins
+//
+// ImGui's allocations always count as ui and miniaudio's as audio, whichever thread makes them, and a job counts
+// as whatever submitted it. Blocks are plain malloc blocks (a block freed by some other module's delete is still
+// fine), and frees ask the heap for the size, so live bytes and their high-water mark are kept for everything
+// together rather than per subsystem.
+// --allocation-stats shows the numbers in a window and writes them to allocation_stats.txt at exit, and
+// --allocation-sample=N records the call stack of every Nth allocation, listed most frequent first.
+// Without PONG_ALLOCATION_CHECK the scopes compile to nothing and allocations aren't looked at.
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+enum allocationTag { allocationOther, allocationSimulation, allocationRender, allocationUI, allocationAudio, allocationTagCount };
+
+#ifdef PONG_ALLOCATION_CHECK
+
+#include <atomic>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include "imgui.h"
+
+#if defined(_WIN32)
+#include <malloc.h>
+#include <windows.h>
+#include <dbghelp.h>
+#pragma comment(lib, "dbghelp.lib")
+#define ALLOCATION_TRACKER_HAS_STACKS 1
+#elif defined(__GLIBC__)
+#include <execinfo.h>
+#include <malloc.h>
+#define ALLOCATION_TRACKER_HAS_STACKS 1
+#endif
+
+class allocationTracker {
+public:
+    static const int historySize = 240;
+    static const int maxCallSites = 512;
+    static const int stackDepth = 12;
+    static const int sitesShown = 5;     // in the window, the file gets all of them
+    static const int framesSkipped = 4;  // captureStack, maybeSample, allocate and operator new (or the ImGui hook)
+
+    struct counters {
+        std::atomic<uint64_t> allocations{ 0 };
+        std::atomic<uint64_t> bytes{ 0 };
+    };
+
+    struct totals {
+        uint64_t allocations;
+        uint64_t bytes;
+    };
+
+    struct callSite {
+        void* frames[stackDepth];
+        int depth;
+        int tag;
+        uint64_t hash;
+        uint64_t samples;
+        uint64_t bytes;
+    };
+
+    static const char* tagName(int tag) {
+        static const char* names[allocationTagCount] = { "other", "sim", "render", "ui", "audio" };
+        return names[tag];
+    }
+
+    static counters* tagCounters() {
+        static counters values[allocationTagCount];
+        return values;
+    }
+
+    static counters& overall() {
+        static counters value;
+        return value;
+    }
+
+    static std::atomic<uint64_t>& frees() {
+        static std::atomic<uint64_t> count{ 0 };
+        return count;
+    }
+
+    static std::atomic<int64_t>& liveBytes() {
+        static std::atomic<int64_t> bytes{ 0 };
+        return bytes;
+    }
+
+    static std::atomic<int64_t>& peakLiveBytes() {
+        static std::atomic<int64_t> bytes{ 0 };
+        return bytes;
+    }
+
+    static int& threadTag() {
+        thread_local int tag = allocationOther;
+        return tag;
+    }
+
+    static totals total() {
+        return { overall().allocations.load(std::memory_order_relaxed), overall().bytes.load(std::memory_order_relaxed) };
+    }
+
+    // --- the allocator everything goes through ---
+
+    static void* allocate(size_t bytes, int tag) {
+        void* p = std::malloc(bytes > 0 ? bytes : 1);
+        if (p == nullptr)
+            return nullptr;
+        charge(tagCounters()[tag], bytes);
+        charge(overall(), bytes);
+        adjustLive(static_cast<int64_t>(blockSize(p)));
+        if (sampleEvery().load(std::memory_order_relaxed) > 0)
+            maybeSample(bytes, tag);
+        return p;
+    }
+
+    static void release(void* p) {
+        if (p == nullptr)
+            return;
+        frees().fetch_add(1, std::memory_order_relaxed);
+        adjustLive(-static_cast<int64_t>(blockSize(p)));
+        std::free(p);
+    }
+
+    // charged to tag as a fresh allocation, which is what it may well cost
+    static void* reallocate(void* p, size_t bytes, int tag) {
+        if (p == nullptr)
+            return allocate(bytes, tag);
+        int64_t oldSize = static_cast<int64_t>(blockSize(p));
+        void* moved = std::realloc(p, bytes > 0 ? bytes : 1);
+        if (moved == nullptr)
+            return nullptr;
+        charge(tagCounters()[tag], bytes);
+        charge(overall(), bytes);
+        adjustLive(static_cast<int64_t>(blockSize(moved)) - oldSize);
+        if (sampleEvery().load(std::memory_order_relaxed) > 0)
+            maybeSample(bytes, tag);
+        return moved;
+    }
+
+    static void* imguiAllocate(size_t bytes, void*) {
+        return allocate(bytes, allocationUI);
+    }
+
+    static void imguiFree(void* p, void*) {
+        release(p);
+    }
+
+    static void* audioAllocate(size_t bytes, void*) {
+        return allocate(bytes, allocationAudio);
+    }
+
+    static void* audioReallocate(void* p, size_t bytes, void*) {
+        return reallocate(p, bytes, allocationAudio);
+    }
+
+    static void audioFree(void* p, void*) {
+        release(p);
+    }
+
+    // --- per frame, on the render thread ---
+
+    bool showPanel = false;
+    std::string dumpPath;
+    uint64_t frames = 0;
+    uint64_t before[allocationTagCount][2] = {};    // allocations and bytes at the top of the frame
+    uint64_t lastFrame[allocationTagCount][2] = {}; // the frame just finished
+    uint64_t mostInAFrame[allocationTagCount][2] = {};
+    uint64_t busiestFrame = 0;
+    uint64_t busiestFrameAllocations = 0;
+    float history[historySize] = {};                // allocations per frame, all tags
+    int historyIndex = 0;
+
+    void init(bool stats, const std::string& path, int sampleRate) {
+        showPanel = stats;
+        dumpPath = stats ? path : std::string();
+        sampleEvery().store(sampleRate > 0 ? sampleRate : 0, std::memory_order_relaxed);
+        if (sampleRate > 0 && !stacksAvailable())
+            std::cout << "--allocation-sample needs a Windows or glibc build, no call sites will be recorded" << std::endl;
+    }
+
+    // before CreateContext, so everything ImGui allocates comes back through imguiFree
+    static void hookImGui() {
+        ImGui::SetAllocatorFunctions(imguiAllocate, imguiFree);
+    }
+
+    // top of the loop: closes the previous frame
+    void beginFrame() {
+        uint64_t frameTotal = 0;
+        for (int tag = 0; tag < allocationTagCount; tag++) {
+            uint64_t now[2] = { tagCounters()[tag].allocations.load(std::memory_order_relaxed),
+                tagCounters()[tag].bytes.load(std::memory_order_relaxed) };
+            for (int i = 0; i < 2; i++) {
+                lastFrame[tag][i] = frames > 0 ? now[i] - before[tag][i] : 0;
+                if (lastFrame[tag][i] > mostInAFrame[tag][i])
+                    mostInAFrame[tag][i] = lastFrame[tag][i];
+                before[tag][i] = now[i];
+            }
+            frameTotal += lastFrame[tag][0];
+        }
+        if (frameTotal > busiestFrameAllocations) {
+            busiestFrameAllocations = frameTotal;
+            busiestFrame = frames - 1;
+        }
+        history[historyIndex] = static_cast<float>(frameTotal);
+        historyIndex = (historyIndex + 1) % historySize;
+        frames++;
+    }
+
+    // call inside an ImGui frame
+    void drawPanel() {
+        if (!showPanel)
+            return;
+
+        ImGui::SetNextWindowBgAlpha(0.6f);
+        ImGui::SetNextWindowPos(ImVec2(10.0f, 520.0f), ImGuiCond_FirstUseEver);
+        ImGui::Begin("Allocations", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings);
+
+        char label[64];
+        snprintf(label, sizeof(label), "%.0f last frame", history[(historyIndex + historySize - 1) % historySize]);
+        ImGui::PlotHistogram("##allocations", history, historySize, historyIndex, label, 0.0f, FLT_MAX, ImVec2(300.0f, 50.0f));
+
+        ImGui::Text("%-6s %6s %9s %6s %11s", "", "frame", "bytes", "most", "most bytes");
+        for (int tag = 0; tag < allocationTagCount; tag++)
+            ImGui::Text("%-6s %6llu %9llu %6llu %11llu", tagName(tag),
+                static_cast<unsigned long long>(lastFrame[tag][0]), static_cast<unsigned long long>(lastFrame[tag][1]),
+                static_cast<unsigned long long>(mostInAFrame[tag][0]), static_cast<unsigned long long>(mostInAFrame[tag][1]));
+        ImGui::Text("live %.1f KB, high-water %.1f KB", liveBytes().load(std::memory_order_relaxed) / 1024.0,
+            peakLiveBytes().load(std::memory_order_relaxed) / 1024.0);
+
+        int every = sampleEvery().load(std::memory_order_relaxed);
+        if (every > 0) {
+            callSite top[sitesShown];
+            int shown = topSites(top, sitesShown);
+            ImGui::Text("top call sites, 1 in %d sampled", every);
+            for (int i = 0; i < shown; i++)
+                ImGui::Text("%6llu  %-6s %p", static_cast<unsigned long long>(top[i].samples), tagName(top[i].tag),
+                    top[i].depth > 0 ? top[i].frames[0] : nullptr);
+        }
+        ImGui::End();
+    }
+
+    // writes dumpPath, if --allocation-stats asked for it. Last thing before exit, so live bytes are what leaked
+    // past every shutdown.
+    void shutdown() {
+        if (dumpPath.empty())
+            return;
+        std::ofstream out(dumpPath);
+        if (!out) {
+            std::cout << "Couldn't write " << dumpPath << std::endl;
+            return;
+        }
+
+        out << "Allocations over " << frames << " frames, the busiest was frame " << busiestFrame << " with "
+            << busiestFrameAllocations << "\n\n";
+        out << std::left << std::setw(8) << "tag" << std::right << std::setw(12) << "allocations" << std::setw(14) << "bytes"
+            << std::setw(14) << "most a frame" << std::setw(20) << "most bytes a frame" << "\n";
+        for (int tag = 0; tag <= allocationTagCount; tag++) {
+            const counters& c = tag < allocationTagCount ? tagCounters()[tag] : overall();
+            out << std::left << std::setw(8) << (tag < allocationTagCount ? tagName(tag) : "total") << std::right
+                << std::setw(12) << c.allocations.load() << std::setw(14) << c.bytes.load();
+            if (tag < allocationTagCount)
+                out << std::setw(14) << mostInAFrame[tag][0] << std::setw(20) << mostInAFrame[tag][1];
+            out << "\n";
+        }
+        out << "\n" << frees().load() << " frees, " << liveBytes().load() << " bytes still live, high-water "
+            << peakLiveBytes().load() << " bytes\n";
+
+        int every = sampleEvery().load(std::memory_order_relaxed);
+        if (every > 0)
+            writeCallSites(out, every);
+        std::cout << "Allocation stats written to " << dumpPath << std::endl;
+    }
+
+private:
+    static void charge(counters& c, size_t bytes) {
+        c.allocations.fetch_add(1, std::memory_order_relaxed);
+        c.bytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    static void adjustLive(int64_t change) {
+        int64_t live = liveBytes().fetch_add(change, std::memory_order_relaxed) + change;
+        int64_t peak = peakLiveBytes().load(std::memory_order_relaxed);
+        while (live > peak && !peakLiveBytes().compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    }
+
+    // what the heap says the block holds, at least what was asked for
+    static size_t blockSize(void* p) {
+#if defined(_WIN32)
+        return _msize(p);
+#elif defined(__GLIBC__)
+        return malloc_usable_size(p);
+#else
+        (void)p;
+        return 0;
+#endif
+    }
+
+    // --- the call site sampler, a fixed table so sampling never allocates ---
+
+    static std::atomic<int>& sampleEvery() {
+        static std::atomic<int> every{ 0 };
+        return every;
+    }
+
+    static std::atomic<uint64_t>& sampleClock() {
+        static std::atomic<uint64_t> clock{ 0 };
+        return clock;
+    }
+
+    static std::atomic<uint64_t>& samplesDropped() {
+        static std::atomic<uint64_t> dropped{ 0 };
+        return dropped;
+    }
+
+    static callSite* sites() {
+        static callSite table[maxCallSites];
+        return table;
+    }
+
+    static std::atomic_flag& sitesLock() {
+        static std::atomic_flag lock = ATOMIC_FLAG_INIT;
+        return lock;
+    }
+
+    static bool stacksAvailable() {
+#ifdef ALLOCATION_TRACKER_HAS_STACKS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    static int captureStack(void** frames) {
+#if defined(_WIN32)
+        return CaptureStackBackTrace(framesSkipped, stackDepth, frames, nullptr);
+#elif defined(ALLOCATION_TRACKER_HAS_STACKS)
+        void* all[stackDepth + framesSkipped];
+        int depth = backtrace(all, stackDepth + framesSkipped) - framesSkipped;
+        for (int i = 0; i < depth; i++)
+            frames[i] = all[i + framesSkipped];
+        return depth > 0 ? depth : 0;
+#else
+        (void)frames;
+        return 0;
+#endif
+    }
+
+    static void maybeSample(size_t bytes, int tag) {
+        uint64_t tick = sampleClock().fetch_add(1, std::memory_order_relaxed);
+        if (tick % static_cast<uint64_t>(sampleEvery().load(std::memory_order_relaxed)) != 0)
+            return;
+
+        void* frames[stackDepth];
+        int depth = captureStack(frames);
+        if (depth == 0)
+            return;
+        uint64_t hash = 14695981039346656037ull; // FNV-1a over the return addresses
+        for (int i = 0; i < depth; i++) {
+            hash ^= reinterpret_cast<uintptr_t>(frames[i]);
+            hash *= 1099511628211ull;
+        }
+
+        while (sitesLock().test_and_set(std::memory_order_acquire)) {}
+        callSite* table = sites();
+        int slot = static_cast<int>(hash % maxCallSites);
+        for (int probe = 0; probe < maxCallSites; probe++, slot = (slot + 1) % maxCallSites) {
+            callSite& site = table[slot];
+            if (site.samples == 0) {
+                for (int i = 0; i < depth; i++)
+                    site.frames[i] = frames[i];
+                site.depth = depth;
+                site.tag = tag;
+                site.hash = hash;
+            }
+            else if (site.hash != hash || site.depth != depth || site.tag != tag)
+                continue;
+            site.samples++;
+            site.bytes += bytes;
+            sitesLock().clear(std::memory_order_release);
+            return;
+        }
+        sitesLock().clear(std::memory_order_release);
+        samplesDropped().fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // copies out the count most sampled sites, most first. Returns how many there were.
+    static int topSites(callSite* out, int count) {
+        int found = 0;
+        while (sitesLock().test_and_set(std::memory_order_acquire)) {}
+        const callSite* table = sites();
+        for (int s = 0; s < maxCallSites; s++) {
+            if (table[s].samples == 0)
+                continue;
+            int at = found < count ? found++ : count;
+            while (at > 0 && out[at - 1].samples < table[s].samples) {
+                if (at < count)
+                    out[at] = out[at - 1];
+                at--;
+            }
+            if (at < count)
+                out[at] = table[s];
+        }
+        sitesLock().clear(std::memory_order_release);
+        return found;
+    }
+
+    static void writeCallSites(std::ofstream& out, int every) {
+        static callSite sorted[maxCallSites]; // static so dumping doesn't allocate a big block of its own
+        int count = topSites(sorted, maxCallSites);
+        out << "\nCall sites, 1 in " << every << " allocations sampled, most first";
+        if (samplesDropped().load() > 0)
+            out << " (" << samplesDropped().load() << " samples didn't fit the table)";
+        out << "\n";
+
+#if defined(_WIN32)
+        HANDLE process = GetCurrentProcess();
+        bool symbols = SymInitialize(process, nullptr, TRUE) != FALSE;
+        SymSetOptions(SymGetOptions() | SYMOPT_LOAD_LINES | SYMOPT_UNDNAME);
+#endif
+        for (int s = 0; s < count; s++) {
+            const callSite& site = sorted[s];
+            out << "\n" << site.samples << " samples, " << site.bytes << " bytes, " << tagName(site.tag) << "\n";
+#if defined(_WIN32)
+            for (int i = 0; i < site.depth; i++) {
+                DWORD64 address = reinterpret_cast<DWORD64>(site.frames[i]);
+                char buffer[sizeof(SYMBOL_INFO) + 256] = {};
+                SYMBOL_INFO* symbol = reinterpret_cast<SYMBOL_INFO*>(buffer);
+                symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+                symbol->MaxNameLen = 255;
+                DWORD64 offset = 0;
+                IMAGEHLP_LINE64 line = {};
+                line.SizeOfStruct = sizeof(line);
+                DWORD lineOffset = 0;
+                out << "    " << site.frames[i];
+                if (symbols && SymFromAddr(process, address, &offset, symbol))
+                    out << " " << symbol->Name;
+                if (symbols && SymGetLineFromAddr64(process, address, &lineOffset, &line))
+                    out << " (" << line.FileName << ":" << line.LineNumber << ")";
+                out << "\n";
+            }
+#elif defined(ALLOCATION_TRACKER_HAS_STACKS)
+            char** names = backtrace_symbols(const_cast<void**>(site.frames), site.depth);
+            for (int i = 0; i < site.depth; i++)
+                out << "    " << (names != nullptr ? names[i] : "?") << "\n";
+            std::free(names);
+#endif
+        }
+#if defined(_WIN32)
+        if (symbols)
+            SymCleanup(process);
+#endif
+    }
+};
+
+// charges the thread's allocations to tag until the end of the scope
+class allocationScope {
+public:
+    int previous;
+
+    explicit allocationScope(int tag) : previous(allocationTracker::threadTag()) {
+        allocationTracker::threadTag() = tag;
+    }
+
+    ~allocationScope() {
+        allocationTracker::threadTag() = previous;
+    }
+};
+
+#define ALLOCATION_SCOPE_CONCAT2(a, b) a##b
+#define ALLOCATION_SCOPE_CONCAT(a, b) ALLOCATION_SCOPE_CONCAT2(a, b)
+#define ALLOCATION_SCOPE(tag) allocationScope ALLOCATION_SCOPE_CONCAT(allocationScope_, __LINE__)(tag)
+
+#ifdef ALLOCATION_TRACKER_IMPLEMENTATION
+// The array, nothrow and sized forms call through to these.
+void* operator new(size_t bytes) {
+    void* p = allocationTracker::allocate(bytes, allocationTracker::threadTag());
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    allocationTracker::release(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    allocationTracker::release(p);
+}
+#endif
+
+#else
+
+#define ALLOCATION_SCOPE(tag)
+
+// nothing tracked, the same calls so main doesn't need an #ifdef at each one
+class allocationTracker {
+public:
+    struct totals {
+        uint64_t allocations;
+        uint64_t bytes;
+    };
+
+    static totals total() {
+        return { 0, 0 };
+    }
+
+    static int threadTag() {
+        return allocationOther;
+    }
+
+    void init(bool stats, const std::string&, int sampleRate) {
+        if (stats || sampleRate > 0)
+            std::cout << "--allocation-stats and --allocation-sample need a build with PONG_ALLOCATION_CHECK defined" << std::endl;
+    }
+
+    static void hookImGui() {}
+    void beginFrame() {}
+    void drawPanel() {}
+    void shutdown() {}
+};
+
+#endif
@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include "mappedFile.h"
+
+// assets.pak: every file the game loads, in one file that is mapped instead of read.
+//
+//     header | index (entryCount entries) | data, each entry starting on a 64 byte boundary
+//
+// Entries are found by their path relative to the game directory, with forward slashes ("sounds/dink.wav").
+// Sounds are stored already decoded to float PCM, so they can be played straight out of the mapping.
+// Written by tools/packAssets.cpp, everything little endian.
+enum assetType : uint32_t { assetRaw = 0, assetPcmF32 = 1 };
+
+struct assetPackHeader {
+    static const uint32_t packMagic = 0x4B415050; // "PPAK"
+    static const uint32_t packVersion = 1;
+    static const uint32_t alignment = 64;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t indexOffset;
+    uint64_t fileSize;
+    uint8_t reserved[40];
+};
+
+struct assetPackEntry {
+    static const int maxName = 48;
+
+    char name[maxName]; // zero terminated
+    uint64_t offset;
+    uint64_t size;      // bytes
+    assetType type;
+    uint32_t channels;  // the rest only means something for assetPcmF32
+    uint32_t sampleRate;
+    uint32_t frameCount;
+};
+
+static_assert(sizeof(assetPackHeader) == 64, "the index starts 64 bytes in");
+static_assert(sizeof(assetPackEntry) == 80, "entries are 80 bytes");
+
+// The pack, read-only mapped into memory. Pointers from data() stay valid until close().
+class assetPack {
+public:
+    mappedFile file;
+    const unsigned char* base = nullptr;
+    uint64_t size = 0;
+    const assetPackEntry* entries = nullptr;
+    uint32_t entryCount = 0;
+
+    bool isOpen() const {
+        return base != nullptr;
+    }
+
+    bool open(const char* path) {
+        close();
+        if (!file.open(path))
+            return false;
+        base = file.data;
+        size = file.size;
+
+        const assetPackHeader* header = reinterpret_cast<const assetPackHeader*>(base);
+        bool valid = size >= sizeof(assetPackHeader) && header->magic == assetPackHeader::packMagic && header->version == assetPackHeader::packVersion
+            && header->fileSize == size && header->indexOffset % alignof(assetPackEntry) == 0
+            && header->indexOffset + static_cast<uint64_t>(header->entryCount) * sizeof(assetPackEntry) <= size;
+        for (uint32_t i = 0; valid && i < header->entryCount; i++) {
+            const assetPackEntry& entry = reinterpret_cast<const assetPackEntry*>(base + header->indexOffset)[i];
+            valid = entry.offset % assetPackHeader::alignment == 0 && entry.offset + entry.size <= size && entry.name[assetPackEntry::maxName - 1] == '\0';
+        }
+        if (!valid) {
+            close();
+            return false;
+        }
+
+        entries = reinterpret_cast<const assetPackEntry*>(base + header->indexOffset);
+        entryCount = header->entryCount;
+        return true;
+    }
+
+    // a handful of entries, a linear search is plenty
+    const assetPackEntry* find(const char* name) const {
+        for (uint32_t i = 0; i < entryCount; i++)
+            if (strcmp(entries[i].name, name) == 0)
+                return &entries[i];
+        return nullptr;
+    }
+
+    const unsigned char* data(const assetPackEntry* entry) const {
+        return base + entry->offset;
+    }
+
+    void close() {
+        file.close();
+        base = nullptr;
+        size = 0;
+        entries = nullptr;
+        entryCount = 0;
+    }
+};
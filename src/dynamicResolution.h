@@ -0,0 +1,264 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <glad/glad.h>
+#include "imgui.h"
+#include "gpuProfiler.h"
+
+// Renders the 3D scene into an offscreen target at a fraction of the window resolution and stretches it onto
+// the real framebuffer, so a weak GPU can hold its frame rate at native fullscreen. ImGui is still drawn at
+// full resolution on top. The fraction is picked every frame from the GPU time of the scene pass (--dynamic-res).
+//
+// The target is allocated once at window size and the scene only uses its lower-left corner, so changing the
+// scale never reallocates anything.
+class dynamicResolution {
+public:
+    bool enabled = false;
+    float scale = 1.0f;      // fraction of the window size along each axis
+    float minScale = 0.5f;
+    float sharpness = 0.0f;  // 0 = plain bilinear upscale
+    uint64_t budget = 0;     // nanoseconds of GPU time a frame may take
+    int cooldown = 0;        // frames until the last change shows up in the GPU timings
+
+    int targetWidth = 0;     // size the target was allocated at
+    int targetHeight = 0;
+    int sceneWidth = 0;      // part of it the current frame uses
+    int sceneHeight = 0;
+    int outputWidth = 0;
+    int outputHeight = 0;
+    GLint outputFramebuffer = 0;
+
+    GLuint framebuffer = 0;
+    GLuint colorTexture = 0;
+    GLuint depthBuffer = 0;
+    GLuint program = 0;
+    GLuint emptyVao = 0;
+    GLint sourceSizeLocation = -1;
+    GLint usedSizeLocation = -1;
+    GLint sharpnessLocation = -1;
+
+    bool init(int width, int height, double budgetMilliseconds, float minScale, float sharpness) {
+        this->minScale = minScale > 0.1f ? (minScale < 1.0f ? minScale : 1.0f) : 0.1f;
+        this->sharpness = sharpness;
+        budget = static_cast<uint64_t>(budgetMilliseconds * 1.0e6);
+        if (!createProgram())
+            return false;
+        glGenVertexArrays(1, &emptyVao);
+        allocate(width, height);
+        enabled = true;
+        return true;
+    }
+
+    void shutdown() {
+        if (!enabled)
+            return;
+        release();
+        glDeleteProgram(program);
+        glDeleteVertexArrays(1, &emptyVao);
+        enabled = false;
+    }
+
+    // top of the frame, with whatever the GPU timings have for the scene and everything else
+    void adjust(const gpuProfiler& timers) {
+        if (!enabled || !timers.passFresh[gpuPassArena])
+            return;
+        // the timings are framesInFlight frames old, so give a change that long to show up before judging it
+        if (cooldown > 0) {
+            cooldown--;
+            return;
+        }
+
+        uint64_t scene = timers.passTime[gpuPassArena];
+        uint64_t fixed = timers.passTime[gpuPassUpscale] + timers.passTime[gpuPassImGui];
+        // scene cost goes with the pixel count, so the scale that fits is sqrt(budget left / scene time) of this one
+        double sceneBudget = budget > fixed + budget / 4 ? static_cast<double>(budget - fixed) : budget / 4.0;
+        double wanted = scale * std::sqrt(sceneBudget / (scene > 0 ? scene : 1));
+
+        // drop quickly when over budget, come back up gently and only for a real gain, so it doesn't hunt
+        double gain = wanted < scale ? 0.75 : 0.25;
+        float next = static_cast<float>(scale + (wanted - scale) * gain);
+        next = next < minScale ? minScale : (next > 1.0f ? 1.0f : next);
+        if (next > scale && next - scale < 0.02f && next != 1.0f)
+            return;
+        if (next != scale)
+            cooldown = gpuProfiler::framesInFlight;
+        scale = next;
+    }
+
+    // instead of clearing the real framebuffer: everything after this lands in the scaled target
+    void beginScene(int width, int height) {
+        if (!enabled)
+            return;
+        if (width > targetWidth || height > targetHeight)
+            allocate(width, height);
+
+        outputWidth = width;
+        outputHeight = height;
+        sceneWidth = static_cast<int>(width * scale + 0.5f);
+        sceneHeight = static_cast<int>(height * scale + 0.5f);
+        if (sceneWidth < 1) sceneWidth = 1;
+        if (sceneHeight < 1) sceneHeight = 1;
+
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &outputFramebuffer); // 0, or the headless target
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(0, 0, sceneWidth, sceneHeight);
+        // glClear ignores the viewport, keep it from clearing the whole 4K target at low scales
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(0, 0, sceneWidth, sceneHeight);
+    }
+
+    // back to the real framebuffer with the scene stretched over it, ready for ImGui
+    void endScene(gpuProfiler& timers) {
+        if (!enabled)
+            return;
+
+        glDisable(GL_SCISSOR_TEST);
+        glBindFramebuffer(GL_FRAMEBUFFER, outputFramebuffer);
+        glViewport(0, 0, outputWidth, outputHeight);
+
+        timers.beginPass(gpuPassUpscale);
+        glDisable(GL_DEPTH_TEST);
+        glUseProgram(program);
+        glUniform2f(sourceSizeLocation, static_cast<float>(targetWidth), static_cast<float>(targetHeight));
+        glUniform2f(usedSizeLocation, static_cast<float>(sceneWidth), static_cast<float>(sceneHeight));
+        glUniform1f(sharpnessLocation, sharpness);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, colorTexture);
+        glBindVertexArray(emptyVao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        timers.countDraw(1);
+        glEnable(GL_DEPTH_TEST);
+        timers.endPass();
+    }
+
+    // adds a line to the --perf-overlay window
+    void drawOverlay(const gpuProfiler& timers) {
+        if (!enabled || !timers.showOverlay)
+            return;
+        ImGui::Begin("Performance"); // appends to the window gpuProfiler opened
+        ImGui::Text("scene %dx%d (%d%%)", sceneWidth, sceneHeight, static_cast<int>(scale * 100.0f + 0.5f));
+        ImGui::End();
+    }
+
+    void allocate(int width, int height) {
+        release();
+        targetWidth = width;
+        targetHeight = height;
+
+        glGenTextures(1, &colorTexture);
+        glBindTexture(GL_TEXTURE_2D, colorTexture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, width, height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        glGenRenderbuffers(1, &depthBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        GLint previous = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous);
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "Dynamic resolution target is incomplete" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, previous);
+    }
+
+    void release() {
+        if (framebuffer == 0)
+            return;
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteTextures(1, &colorTexture);
+        glDeleteRenderbuffers(1, &depthBuffer);
+        framebuffer = 0;
+        colorTexture = 0;
+        depthBuffer = 0;
+    }
+
+    static bool compile(GLuint shader, const char* source) {
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+        int success = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            char infoLog[512];
+            glGetShaderInfoLog(shader, 512, NULL, infoLog);
+            std::cout << "ERROR::SHADER::UPSCALE::COMPILATION_FAILED\n" << infoLog << std::endl;
+        }
+        return success != 0;
+    }
+
+    bool createProgram() {
+        // one triangle that covers the screen, no vertex buffer needed
+        const char* vertexSource =
+            "#version 450 core\n"
+            "out vec2 uv;\n"
+            "void main()\n"
+            "{\n"
+            "    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+            "    uv = corner;\n"
+            "    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);\n"
+            "}";
+
+        // bilinear from the used corner of the target, plus an optional unsharp mask to win back some detail
+        const char* fragmentSource =
+            "#version 450 core\n"
+            "in vec2 uv;\n"
+            "out vec4 FragColor;\n"
+            "uniform sampler2D scene;\n"
+            "uniform vec2 sourceSize;\n"
+            "uniform vec2 usedSize;\n"
+            "uniform float sharpness;\n"
+            "vec3 tap(vec2 pixel)\n"
+            "{\n"
+            "    // stay half a texel inside the used area so bilinear never blends in stale pixels next to it\n"
+            "    pixel = clamp(pixel, vec2(0.5), usedSize - 0.5);\n"
+            "    return texture(scene, pixel / sourceSize).rgb;\n"
+            "}\n"
+            "void main()\n"
+            "{\n"
+            "    vec2 pixel = uv * usedSize;\n"
+            "    vec3 color = tap(pixel);\n"
+            "    if (sharpness > 0.0) {\n"
+            "        vec3 around = tap(pixel + vec2(1.0, 0.0)) + tap(pixel - vec2(1.0, 0.0))\n"
+            "            + tap(pixel + vec2(0.0, 1.0)) + tap(pixel - vec2(0.0, 1.0));\n"
+            "        color = clamp(color + sharpness * (color * 4.0 - around), 0.0, 1.0);\n"
+            "    }\n"
+            "    FragColor = vec4(color, 1.0);\n"
+            "}";
+
+        GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        bool compiled = compile(vertexShader, vertexSource) && compile(fragmentShader, fragmentSource);
+
+        program = glCreateProgram();
+        glAttachShader(program, vertexShader);
+        glAttachShader(program, fragmentShader);
+        glLinkProgram(program);
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+
+        int linked = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!compiled || !linked) {
+            std::cout << "Couldn't build the dynamic resolution upscale shader" << std::endl;
+            return false;
+        }
+
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "scene"), 0);
+        sourceSizeLocation = glGetUniformLocation(program, "sourceSize");
+        usedSizeLocation = glGetUniformLocation(program, "usedSize");
+        sharpnessLocation = glGetUniformLocation(program, "sharpness");
+        glUseProgram(0);
+        return true;
+    }
+};
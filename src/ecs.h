@@ -0,0 +1,243 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Entities grouped by archetype, the exact set of components they have. Each archetype keeps its entities in
+// fixed size chunks, and inside a chunk every component type is its own packed array, so a system touching two
+// components of 100k entities walks two arrays front to back and never sees the rest.
+//
+//     ecsWorld world;
+//     entity ball = world.create(transform{ ... }, velocity{ ... }, renderable{ modelBall });
+//     world.each<transform, velocity>([dt](transform& t, velocity& v) { t.position += v.value * dt; });
+//     world.get<velocity>(ball)->value = glm::vec3(0.0f);
+//
+// Components are plain structs (they're moved with memcpy). An entity's set of components is fixed when it's
+// created, the game never adds or removes one later, so entities only move chunks when one is destroyed.
+
+struct entity {
+    uint32_t index = UINT32_MAX;
+    uint32_t generation = 0; // bumped when the index is reused, so an old handle stops resolving
+};
+
+// every component type gets a bit the first time it's used. 32 is plenty for a pong game.
+inline int nextComponentBit() {
+    static int next = 0;
+    return next++;
+}
+
+template <typename T>
+int componentBit() {
+    static_assert(std::is_trivially_copyable<T>::value, "components are moved around with memcpy");
+    static const int bit = nextComponentBit();
+    return bit;
+}
+
+template <typename... C>
+uint32_t componentMask() {
+    uint32_t mask = 0;
+    int bits[] = { 0, (mask |= 1u << componentBit<C>(), 0)... };
+    (void)bits;
+    return mask;
+}
+
+class ecsWorld {
+public:
+    static const size_t chunkBytes = 16 * 1024;
+
+    struct column {
+        int bit;
+        size_t size;
+        size_t offset; // of this component's array in every chunk
+    };
+
+    struct chunk {
+        std::unique_ptr<unsigned char[]> data;
+        int count = 0;
+    };
+
+    struct archetype {
+        uint32_t mask;
+        int capacity;               // entities per chunk
+        std::vector<column> columns;
+        int columnOfBit[32];        // -1 where the archetype doesn't have the component
+        std::vector<chunk> chunks;  // all full except the last
+        std::vector<uint32_t> owners; // entity index per slot, chunk after chunk
+
+        template <typename T>
+        T* array(chunk& c) const {
+            return reinterpret_cast<T*>(c.data.get() + columns[columnOfBit[componentBit<T>()]].offset);
+        }
+    };
+
+    struct location {
+        int archetype = -1;
+        int slot = 0; // chunk * capacity + index in the chunk
+        uint32_t generation = 0;
+    };
+
+    std::vector<archetype> archetypes;
+    std::vector<location> entities;
+    std::vector<uint32_t> freeIndices;
+    int alive = 0;
+
+    template <typename... C>
+    entity create(const C&... components) {
+        archetype& a = archetypes[archetypeFor<C...>()];
+        int slot = static_cast<int>(a.owners.size());
+        if (slot == static_cast<int>(a.chunks.size()) * a.capacity) {
+            a.chunks.emplace_back();
+            a.chunks.back().data.reset(new unsigned char[chunkBytes]);
+        }
+        chunk& c = a.chunks[slot / a.capacity];
+        int bits[] = { 0, (new (a.array<C>(c) + c.count) C(components), 0)... };
+        (void)bits;
+        c.count++;
+
+        entity e;
+        if (freeIndices.empty()) {
+            e.index = static_cast<uint32_t>(entities.size());
+            entities.emplace_back();
+        }
+        else {
+            e.index = freeIndices.back();
+            freeIndices.pop_back();
+        }
+        location& where = entities[e.index];
+        where.archetype = static_cast<int>(&a - archetypes.data());
+        where.slot = slot;
+        e.generation = where.generation;
+        a.owners.push_back(e.index);
+        alive++;
+        return e;
+    }
+
+    // the last entity of the archetype moves into the hole, so chunks stay packed
+    void destroy(entity e) {
+        if (!isAlive(e))
+            return;
+        location& where = entities[e.index];
+        archetype& a = archetypes[where.archetype];
+        int last = static_cast<int>(a.owners.size()) - 1;
+        if (where.slot != last) {
+            for (const column& col : a.columns)
+                std::memcpy(componentAt(a, col, where.slot), componentAt(a, col, last), col.size);
+            a.owners[where.slot] = a.owners[last];
+            entities[a.owners[where.slot]].slot = where.slot;
+        }
+        a.owners.pop_back();
+        chunk& lastChunk = a.chunks[last / a.capacity];
+        if (--lastChunk.count == 0)
+            a.chunks.pop_back();
+
+        where.archetype = -1;
+        where.generation++;
+        freeIndices.push_back(e.index);
+        alive--;
+    }
+
+    bool isAlive(entity e) const {
+        return e.index < entities.size() && entities[e.index].archetype >= 0 && entities[e.index].generation == e.generation;
+    }
+
+    // nullptr when the entity is gone or doesn't have one. Valid until the next create or destroy.
+    template <typename T>
+    T* get(entity e) {
+        if (!isAlive(e))
+            return nullptr;
+        const location& where = entities[e.index];
+        archetype& a = archetypes[where.archetype];
+        int column = a.columnOfBit[componentBit<T>()];
+        if (column < 0)
+            return nullptr;
+        return reinterpret_cast<T*>(componentAt(a, a.columns[column], where.slot));
+    }
+
+    // f(count, C* arrays...) once per chunk of every archetype that has all of C, for loops over whole arrays
+    template <typename... C, typename F>
+    void eachChunk(F f) {
+        uint32_t mask = componentMask<C...>();
+        for (archetype& a : archetypes) {
+            if ((a.mask & mask) != mask)
+                continue;
+            for (chunk& c : a.chunks)
+                f(c.count, a.array<C>(c)...);
+        }
+    }
+
+    struct chunkRef {
+        archetype* owner;
+        chunk* data;
+    };
+
+    // every chunk with all of C, for handing out to threads. Valid until the next create or destroy.
+    template <typename... C>
+    void matchingChunks(std::vector<chunkRef>& out) {
+        out.clear();
+        uint32_t mask = componentMask<C...>();
+        for (archetype& a : archetypes) {
+            if ((a.mask & mask) != mask)
+                continue;
+            for (chunk& c : a.chunks)
+                out.push_back({ &a, &c });
+        }
+    }
+
+    // f(C&...) for every entity with all of C
+    template <typename... C, typename F>
+    void each(F f) {
+        eachChunk<C...>([&f](int count, C*... arrays) {
+            for (int i = 0; i < count; i++)
+                f(arrays[i]...);
+        });
+    }
+
+    // how many entities have all of C
+    template <typename... C>
+    int count() {
+        uint32_t mask = componentMask<C...>();
+        int total = 0;
+        for (const archetype& a : archetypes)
+            if ((a.mask & mask) == mask)
+                total += static_cast<int>(a.owners.size());
+        return total;
+    }
+
+private:
+    unsigned char* componentAt(archetype& a, const column& col, int slot) {
+        return a.chunks[slot / a.capacity].data.get() + col.offset + col.size * (slot % a.capacity);
+    }
+
+    template <typename... C>
+    int archetypeFor() {
+        uint32_t mask = componentMask<C...>();
+        for (size_t i = 0; i < archetypes.size(); i++)
+            if (archetypes[i].mask == mask)
+                return static_cast<int>(i);
+
+        archetypes.emplace_back();
+        archetype& a = archetypes.back();
+        a.mask = mask;
+        for (int& column : a.columnOfBit)
+            column = -1;
+        int bits[] = { 0, (a.columns.push_back({ componentBit<C>(), sizeof(C), 0 }), 0)... };
+        (void)bits;
+
+        // as many entities as fit with every array starting 16 byte aligned
+        size_t entityBytes = 0;
+        for (const column& col : a.columns)
+            entityBytes += col.size;
+        a.capacity = static_cast<int>((chunkBytes - 16 * a.columns.size()) / entityBytes);
+        size_t offset = 0;
+        for (size_t i = 0; i < a.columns.size(); i++) {
+            a.columns[i].offset = offset;
+            offset += (a.columns[i].size * a.capacity + 15) & ~static_cast<size_t>(15);
+            a.columnOfBit[a.columns[i].bit] = static_cast<int>(i);
+        }
+        return static_cast<int>(archetypes.size()) - 1;
+    }
+};
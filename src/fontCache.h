@@ -0,0 +1,252 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "imgui.h"
+#include "imgui_internal.h"
+#include "imgui_impl_opengl3.h"
+#include "gameClock.h"
+
+// Loads the game font once and hands ImGui every size from that one copy, then bakes the atlas up front instead of
+// on the first ImGui frame. The baked atlas (pixels and glyph tables) is saved next to the font, keyed by a hash of
+// the TTF and everything else that changes the output, so later runs skip stb_truetype entirely.
+//
+//     fonts.loadFile("fonts/VCR_OSD_MONO_1.001.ttf");  // or fonts.useMemory() with bytes that outlive ImGui
+//     ImFont* big = fonts.addSize(io.Fonts, 120.0f);
+//     fonts.bake(io.Fonts, "fonts/VCR_OSD_MONO_1.001.atlas");      // no GL, any thread that owns the atlas
+//     fonts.upload();                                              // after ImGui_ImplOpenGL3_Init
+class fontCache {
+public:
+    static const uint32_t fileMagic = 0x43415046; // "FPAC"
+    static const uint32_t fileVersion = 1;
+
+    const unsigned char* ttf = nullptr; // shared by every size, the atlas only borrows it
+    size_t ttfSize = 0;
+    std::vector<unsigned char> ttfFile; // what ttf points at when it came from loadFile
+    std::string cachePath;
+    uint64_t key = 0;
+    bool fromCache = false;
+    double bakeMilliseconds = 0.0;
+
+    bool loadFile(const char* path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+        ttfFile.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return useMemory(ttfFile.data(), ttfFile.size());
+    }
+
+    bool useMemory(const unsigned char* data, size_t size) {
+        ttf = size > 0 ? data : nullptr;
+        ttfSize = size;
+        return ttf != nullptr;
+    }
+
+    // the game only ever prints ASCII, no point baking Latin-1 at 120 px
+    static const ImWchar* glyphRanges() {
+        static const ImWchar ranges[] = { 0x0020, 0x007E, 0 };
+        return ranges;
+    }
+
+    ImFont* addSize(ImFontAtlas* atlas, float pixels) {
+        if (ttf == nullptr)
+            return atlas->AddFontDefault();
+        ImFontConfig config;
+        config.FontDataOwnedByAtlas = false; // ImGui only reads it, so the const_cast is safe
+        return atlas->AddFontFromMemoryTTF(const_cast<unsigned char*>(ttf), static_cast<int>(ttfSize), pixels, &config, glyphRanges());
+    }
+
+    // Bakes the atlas, from the cache file when it matches, so the first frame has nothing left to do. An empty
+    // path bakes without caching. Only touches the atlas, nothing else in ImGui.
+    bool bake(ImFontAtlas* atlas, const std::string& path) {
+        static ImFontBuilderIO builder;
+        builder.FontBuilder_Build = build;
+        cachePath = path;
+        atlas->UserData = this;
+        atlas->FontBuilderIO = &builder;
+
+        uint64_t start = nowNanoseconds();
+        bool built = atlas->Build();
+        bakeMilliseconds = (nowNanoseconds() - start) / 1.0e6;
+        std::cout << "Font atlas " << atlas->TexWidth << "x" << atlas->TexHeight << (fromCache ? " loaded from cache" : " rasterized")
+            << " in " << bakeMilliseconds << " ms" << std::endl;
+        return built;
+    }
+
+    // creates the font texture from the baked atlas, on the GL thread
+    static bool upload() {
+        return ImGui_ImplOpenGL3_CreateDeviceObjects();
+    }
+
+    static uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++)
+            hash = (hash ^ bytes[i]) * 0x100000001b3ull; // FNV-1a
+        return hash;
+    }
+
+    template <typename T>
+    static uint64_t hashValue(uint64_t hash, const T& value) {
+        return hashBytes(hash, &value, sizeof(value));
+    }
+
+    // everything that goes into the baked output. Called after ImFontAtlasBuildInit so the custom rects are known.
+    static uint64_t atlasKey(ImFontAtlas* atlas) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        hash = hashValue(hash, IMGUI_VERSION_NUM);
+        hash = hashValue(hash, sizeof(ImFontGlyph));
+        hash = hashValue(hash, atlas->Flags);
+        hash = hashValue(hash, atlas->TexDesiredWidth);
+        hash = hashValue(hash, atlas->TexGlyphPadding);
+        for (const ImFontAtlasCustomRect& rect : atlas->CustomRects) {
+            hash = hashValue(hash, rect.Width);
+            hash = hashValue(hash, rect.Height);
+        }
+        for (const ImFontConfig& src : atlas->Sources) {
+            hash = hashBytes(hash, src.FontData, static_cast<size_t>(src.FontDataSize));
+            hash = hashValue(hash, src.FontNo);
+            hash = hashValue(hash, src.SizePixels);
+            hash = hashValue(hash, src.OversampleH);
+            hash = hashValue(hash, src.OversampleV);
+            hash = hashValue(hash, src.PixelSnapH);
+            hash = hashValue(hash, src.MergeMode);
+            hash = hashValue(hash, src.GlyphOffset.x);
+            hash = hashValue(hash, src.GlyphOffset.y);
+            hash = hashValue(hash, src.GlyphMinAdvanceX);
+            hash = hashValue(hash, src.GlyphMaxAdvanceX);
+            hash = hashValue(hash, src.GlyphExtraAdvanceX);
+            hash = hashValue(hash, src.RasterizerMultiply);
+            hash = hashValue(hash, src.RasterizerDensity);
+            for (const ImWchar* range = src.GlyphRanges ? src.GlyphRanges : atlas->GetGlyphRangesDefault(); range[0] != 0; range++)
+                hash = hashValue(hash, range[0]);
+        }
+        return hash;
+    }
+
+    // stands in for ImGui's stb_truetype builder
+    static bool build(ImFontAtlas* atlas) {
+        fontCache* cache = static_cast<fontCache*>(atlas->UserData);
+        ImFontAtlasBuildInit(atlas);
+
+        // glyphs mapped onto custom rects are added again by ImFontAtlasBuildFinish, so a cached copy would double
+        // them. Merged fonts would need their sources replayed in order. Neither happens here, so just don't cache them.
+        bool cacheable = !cache->cachePath.empty();
+        for (const ImFontAtlasCustomRect& rect : atlas->CustomRects)
+            cacheable = cacheable && rect.Font == nullptr;
+        for (const ImFontConfig& src : atlas->Sources)
+            cacheable = cacheable && !src.MergeMode;
+
+        if (cacheable) {
+            cache->key = atlasKey(atlas);
+            if (cache->load(atlas)) {
+                cache->fromCache = true;
+                return true;
+            }
+        }
+
+        if (!ImFontAtlasGetBuilderForStbTruetype()->FontBuilder_Build(atlas))
+            return false;
+        if (cacheable && !cache->save(atlas))
+            std::cout << "Couldn't write font cache " << cache->cachePath << std::endl;
+        return true;
+    }
+
+    template <typename T>
+    static void write(std::ofstream& file, T value) { // by value, so the static consts need no definition
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename T>
+    static bool read(std::ifstream& file, T& value) {
+        return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    bool save(const ImFontAtlas* atlas) const {
+        std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+        write(file, fileMagic);
+        write(file, fileVersion);
+        write(file, key);
+        write(file, atlas->TexWidth);
+        write(file, atlas->TexHeight);
+        for (const ImFontAtlasCustomRect& rect : atlas->CustomRects) {
+            write(file, rect.X);
+            write(file, rect.Y);
+        }
+        for (const ImFont* font : atlas->Fonts) {
+            write(file, font->Ascent);
+            write(file, font->Descent);
+            write(file, font->Glyphs.Size);
+            file.write(reinterpret_cast<const char*>(font->Glyphs.Data), font->Glyphs.size_in_bytes());
+        }
+        file.write(reinterpret_cast<const char*>(atlas->TexPixelsAlpha8), static_cast<std::streamsize>(atlas->TexWidth) * atlas->TexHeight);
+        return static_cast<bool>(file);
+    }
+
+    // Fills the atlas the way the stb_truetype builder would have. Reads everything before touching the atlas, so a
+    // stale or truncated file just means rasterizing as usual.
+    bool load(ImFontAtlas* atlas) const {
+        std::ifstream file(cachePath, std::ios::binary);
+        if (!file)
+            return false;
+
+        uint32_t magic = 0, version = 0;
+        uint64_t fileKey = 0;
+        int width = 0, height = 0;
+        if (!read(file, magic) || !read(file, version) || !read(file, fileKey) || magic != fileMagic || version != fileVersion || fileKey != key)
+            return false;
+        if (!read(file, width) || !read(file, height) || width <= 0 || height <= 0)
+            return false;
+
+        std::vector<unsigned short> rectPositions(static_cast<size_t>(atlas->CustomRects.Size) * 2);
+        for (unsigned short& position : rectPositions)
+            if (!read(file, position))
+                return false;
+
+        struct fontData { float ascent, descent; std::vector<ImFontGlyph> glyphs; };
+        std::vector<fontData> fonts(static_cast<size_t>(atlas->Fonts.Size));
+        for (fontData& font : fonts) {
+            int glyphCount = 0;
+            if (!read(file, font.ascent) || !read(file, font.descent) || !read(file, glyphCount) || glyphCount < 0 || glyphCount >= 0xFFFF)
+                return false;
+            font.glyphs.resize(static_cast<size_t>(glyphCount));
+            if (!file.read(reinterpret_cast<char*>(font.glyphs.data()), sizeof(ImFontGlyph) * glyphCount))
+                return false;
+        }
+
+        std::vector<unsigned char> pixels(static_cast<size_t>(width) * height);
+        if (!file.read(reinterpret_cast<char*>(pixels.data()), static_cast<std::streamsize>(pixels.size())))
+            return false;
+
+        atlas->TexID = (ImTextureID)NULL;
+        atlas->ClearTexData();
+        atlas->TexWidth = width;
+        atlas->TexHeight = height;
+        atlas->TexUvScale = ImVec2(1.0f / width, 1.0f / height);
+        atlas->TexPixelsAlpha8 = static_cast<unsigned char*>(IM_ALLOC(pixels.size()));
+        memcpy(atlas->TexPixelsAlpha8, pixels.data(), pixels.size());
+        for (int i = 0; i < atlas->CustomRects.Size; i++) {
+            atlas->CustomRects[i].X = rectPositions[i * 2];
+            atlas->CustomRects[i].Y = rectPositions[i * 2 + 1];
+        }
+
+        for (int i = 0; i < atlas->Fonts.Size; i++) {
+            ImFont* font = atlas->Fonts[i];
+            ImFontAtlasBuildSetupFont(atlas, font, font->Sources, fonts[i].ascent, fonts[i].descent);
+            for (const ImFontGlyph& glyph : fonts[i].glyphs) {
+                // without a config AddGlyph takes the numbers as they are, they're already adjusted
+                font->AddGlyph(nullptr, static_cast<ImWchar>(glyph.Codepoint), glyph.X0, glyph.Y0, glyph.X1, glyph.Y1,
+                    glyph.U0, glyph.V0, glyph.U1, glyph.V1, glyph.AdvanceX);
+                font->Glyphs.back().Colored = glyph.Colored;
+            }
+        }
+
+        ImFontAtlasBuildFinish(atlas); // white pixel, mouse cursors, line textures and the lookup tables
+        return true;
+    }
+};
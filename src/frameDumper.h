@@ -0,0 +1,98 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pixelReadback.h"
+#include "pngWriter.h"
+
+// Worker thread that turns frames from a pixelReadback into prefix_000123.png files. It copies each frame out
+// of the mapped buffer and releases the slot before encoding, so the ring keeps moving while PNGs are written.
+class frameDumper {
+public:
+    struct job {
+        int slot;
+        const uint8_t* pixels;
+        int width;
+        int height;
+        uint64_t frameIndex;
+    };
+
+    pixelReadback* readback = nullptr;
+    std::string prefix;
+
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<job> jobs;
+    bool stopping = false;
+
+    std::vector<uint8_t> copy;
+    pngWriter png;
+    uint64_t written = 0;
+    uint64_t failed = 0;
+
+    void start(pixelReadback* readback, const std::string& prefix) {
+        this->readback = readback;
+        this->prefix = prefix;
+        stopping = false;
+        worker = std::thread([this] { run(); });
+    }
+
+    // game thread, from pixelReadback::poll
+    void push(int slot, const uint8_t* pixels, int width, int height, uint64_t frameIndex) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back({ slot, pixels, width, height, frameIndex });
+        }
+        wake.notify_one();
+    }
+
+    // writes whatever is still queued, then ends the thread
+    void stop() {
+        if (!worker.joinable())
+            return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+        std::cout << "Dumped " << written << " frames to " << prefix << "_*.png";
+        if (failed > 0)
+            std::cout << ", " << failed << " couldn't be written";
+        std::cout << std::endl;
+    }
+
+    void run() {
+        while (true) {
+            job next;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty())
+                    return;
+                next = jobs.front();
+                jobs.pop_front();
+            }
+
+            size_t rowBytes = static_cast<size_t>(next.width) * 4;
+            copy.assign(next.pixels, next.pixels + rowBytes * next.height);
+            readback->release(next.slot);
+
+            char name[32];
+            snprintf(name, sizeof(name), "_%06llu.png", static_cast<unsigned long long>(next.frameIndex));
+            // glReadPixels rows start at the bottom, so write them last to first
+            const uint8_t* lastRow = copy.data() + rowBytes * (next.height - 1);
+            if (png.write(prefix + name, lastRow, next.width, next.height, -static_cast<int>(rowBytes)))
+                written++;
+            else
+                failed++;
+        }
+    }
+};
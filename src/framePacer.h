@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <thread>
+#include <GLFW/glfw3.h>
+#include "gameClock.h"
+
+// How late the OS wakes a sleeping thread, learnt as we go. Sleep until spinTime() before a deadline and spin the
+// rest. The estimate stays within the spin limits, so one very late wake can't stop a thread from ever sleeping again.
+class oversleepTracker {
+public:
+    static const uint64_t minSpinTime = 200000;    // 0.2 ms
+    static const uint64_t maxSpinTime = 4000000;   // 4 ms, the Windows scheduler can be this coarse without timeBeginPeriod
+
+    uint64_t estimate = 1000000;
+
+    uint64_t spinTime() const {
+        return estimate;
+    }
+
+    // after asking to sleep for requested nanoseconds and getting slept
+    void record(uint64_t requested, uint64_t slept) {
+        if (slept <= requested)
+            return;
+        uint64_t oversleep = slept - requested;
+        estimate = oversleep > estimate ? oversleep : estimate - estimate / 64;
+        if (estimate < minSpinTime)
+            estimate = minSpinTime;
+        if (estimate > maxSpinTime)
+            estimate = maxSpinTime;
+    }
+};
+
+// Holds the loop to a target frame rate without burning a core, and lets static screens sleep until
+// something happens. Waiting is done in glfwWaitEventsTimeout so key presses that come in while
+// we wait are still delivered (and timestamped) straight away instead of at the next poll.
+class framePacer {
+public:
+    uint64_t framePeriod = 0;      // 0 = no limit, rely on vsync
+    uint64_t nextDeadline = 0;
+
+    oversleepTracker oversleep;
+
+    bool idleWhenStatic = true;
+    double idleTimeout = 0.25;      // static screens still redraw a few times a second
+    int activeFramesAfterEvent = 3; // ImGui needs a couple of frames to show hover/click changes
+    int framesSinceActivity = 0;
+    uint64_t lastEventCount = 0;
+
+    void init(int targetFrameRate, bool idleWhenStatic) {
+        framePeriod = targetFrameRate > 0 ? 1000000000ull / targetFrameRate : 0;
+        this->idleWhenStatic = idleWhenStatic;
+        nextDeadline = 0;
+    }
+
+    // coarse OS sleep (pumping events) until oversleep.spinTime() before the deadline, then spin
+    void sleepUntil(uint64_t deadline) {
+        uint64_t now = nowNanoseconds();
+
+        while (now + oversleep.spinTime() < deadline) {
+            uint64_t requested = deadline - now - oversleep.spinTime();
+            glfwWaitEventsTimeout(nanosecondsToSeconds(requested));
+
+            uint64_t woke = nowNanoseconds();
+            oversleep.record(requested, woke - now);
+            now = woke;
+        }
+
+        while (nowNanoseconds() < deadline)
+            std::this_thread::yield();
+    }
+
+    // call at the top of every loop iteration. eventCount is anything that increases when input arrives.
+    void waitForNextFrame(bool staticScreen, uint64_t eventCount) {
+        if (eventCount != lastEventCount) {
+            lastEventCount = eventCount;
+            framesSinceActivity = 0;
+        }
+
+        if (idleWhenStatic && staticScreen && framesSinceActivity >= activeFramesAfterEvent) {
+            // nothing on screen changes on its own, sleep until there is input or the timeout
+            glfwWaitEventsTimeout(idleTimeout);
+            nextDeadline = 0;
+            return;
+        }
+        framesSinceActivity++;
+
+        if (framePeriod == 0)
+            return;
+
+        uint64_t now = nowNanoseconds();
+        if (nextDeadline == 0 || now > nextDeadline + framePeriod)
+            nextDeadline = now; // first frame, or we fell far behind: don't try to catch up with a burst
+        else
+            sleepUntil(nextDeadline);
+
+        nextDeadline += framePeriod;
+    }
+};
@@ -0,0 +1,200 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "gameClock.h"
+#include "hdrHistogram.h"
+
+enum framePhase { phaseInput, phaseSimulation, phaseRender, phaseImGui, phaseSwap, phaseOther, phaseWait, phaseCount };
+
+// CPU time of each part of every frame: kept in a ring for the CSV, histograms for percentiles, and a
+// list of hitches with the phase that caused them. Enabled with --frame-stats, written out at exit.
+// phaseWait is the frame pacer's sleep (--fps-limit, idle menus). It's recorded, but it isn't work, so it's left
+// out of the frame's total and can't make a hitch.
+class frameTelemetry {
+public:
+    static const int ringSize = 4096;
+    static const int maxHitches = 1024;
+
+    struct frameRecord {
+        uint64_t frameIndex = 0;
+        uint64_t total = 0;
+        uint64_t phases[phaseCount] = {};
+    };
+
+    struct hitch {
+        uint64_t frameIndex = 0;
+        uint64_t total = 0;
+        framePhase cause = phaseOther;
+        uint64_t causeTime = 0;
+    };
+
+    // adds the time between construction and destruction to a phase of the current frame
+    class phaseScope {
+    public:
+        frameTelemetry& telemetry;
+        framePhase phase;
+        uint64_t start;
+
+        phaseScope(frameTelemetry& telemetry, framePhase phase) : telemetry(telemetry), phase(phase) {
+            start = telemetry.enabled ? nowNanoseconds() : 0;
+        }
+
+        ~phaseScope() {
+            if (telemetry.enabled)
+                telemetry.current.phases[phase] += nowNanoseconds() - start;
+        }
+    };
+
+    bool enabled = false;
+    std::string outputPrefix = "frame_stats";
+    uint64_t hitchThreshold = 25000000;
+
+    // single producer (the main loop) writes, readers take whatever has been published
+    frameRecord ring[ringSize];
+    std::atomic<uint64_t> written{ 0 };
+
+    hdrHistogram phaseHistograms[phaseCount];
+    hdrHistogram totalHistogram;
+    std::vector<hitch> hitches;
+
+    frameRecord current;
+    uint64_t frameStart = 0;
+    uint64_t frameIndex = 0;
+
+    static const char* phaseName(int phase) {
+        static const char* names[phaseCount] = { "input", "simulation", "render", "imgui", "swap", "other", "wait" };
+        return names[phase];
+    }
+
+    void init(bool enabled, const std::string& outputPrefix, double hitchMilliseconds) {
+        this->enabled = enabled;
+        this->outputPrefix = outputPrefix;
+        hitchThreshold = static_cast<uint64_t>(hitchMilliseconds * 1.0e6);
+        if (enabled)
+            hitches.reserve(maxHitches);
+    }
+
+    // top of the loop: closes the previous frame and starts timing the next one
+    void beginFrame() {
+        if (!enabled)
+            return;
+
+        uint64_t now = nowNanoseconds();
+        if (frameStart != 0)
+            endFrame(now - frameStart);
+
+        frameStart = now;
+        current = frameRecord();
+        current.frameIndex = frameIndex++;
+    }
+
+    void endFrame(uint64_t elapsed) {
+        uint64_t waited = current.phases[phaseWait];
+        uint64_t total = elapsed > waited ? elapsed - waited : 0;
+        uint64_t attributed = 0;
+        for (int i = 0; i < phaseCount; i++) {
+            if (i != phaseWait)
+                attributed += current.phases[i];
+        }
+        current.phases[phaseOther] += total > attributed ? total - attributed : 0;
+        current.total = total;
+
+        uint64_t index = written.load(std::memory_order_relaxed);
+        ring[index % ringSize] = current;
+        written.store(index + 1, std::memory_order_release);
+
+        totalHistogram.record(total);
+        for (int i = 0; i < phaseCount; i++)
+            phaseHistograms[i].record(current.phases[i]);
+
+        if (total > hitchThreshold && hitches.size() < maxHitches) {
+            hitch h;
+            h.frameIndex = current.frameIndex;
+            h.total = total;
+            for (int i = 0; i < phaseCount; i++) {
+                if (i != phaseWait && current.phases[i] > h.causeTime) {
+                    h.causeTime = current.phases[i];
+                    h.cause = static_cast<framePhase>(i);
+                }
+            }
+            hitches.push_back(h);
+        }
+    }
+
+    static void writePercentiles(std::ofstream& out, const hdrHistogram& histogram) {
+        out << "{ \"p50\": " << histogram.percentile(50.0) / 1.0e6
+            << ", \"p99\": " << histogram.percentile(99.0) / 1.0e6
+            << ", \"p99.9\": " << histogram.percentile(99.9) / 1.0e6
+            << ", \"max\": " << histogram.maxValue / 1.0e6
+            << ", \"mean\": " << histogram.mean() / 1.0e6 << " }";
+    }
+
+    void writeJson(const std::string& path) {
+        std::ofstream out(path);
+        if (!out) {
+            std::cout << "Couldn't write " << path << std::endl;
+            return;
+        }
+
+        out << "{\n";
+        out << "  \"frames\": " << totalHistogram.total << ",\n";
+        out << "  \"hitchThresholdMs\": " << hitchThreshold / 1.0e6 << ",\n";
+        out << "  \"frameMs\": ";
+        writePercentiles(out, totalHistogram);
+        out << ",\n  \"phasesMs\": {\n";
+        for (int i = 0; i < phaseCount; i++) {
+            out << "    \"" << phaseName(i) << "\": ";
+            writePercentiles(out, phaseHistograms[i]);
+            out << (i + 1 < phaseCount ? ",\n" : "\n");
+        }
+        out << "  },\n  \"hitches\": [\n";
+        for (size_t i = 0; i < hitches.size(); i++) {
+            out << "    { \"frame\": " << hitches[i].frameIndex
+                << ", \"totalMs\": " << hitches[i].total / 1.0e6
+                << ", \"cause\": \"" << phaseName(hitches[i].cause) << "\""
+                << ", \"causeMs\": " << hitches[i].causeTime / 1.0e6 << " }"
+                << (i + 1 < hitches.size() ? ",\n" : "\n");
+        }
+        out << "  ]\n}\n";
+    }
+
+    // the last ringSize frames
+    void writeCsv(const std::string& path) {
+        std::ofstream out(path);
+        if (!out) {
+            std::cout << "Couldn't write " << path << std::endl;
+            return;
+        }
+
+        out << "frame,total_ms";
+        for (int i = 0; i < phaseCount; i++)
+            out << ',' << phaseName(i) << "_ms";
+        out << '\n';
+
+        uint64_t end = written.load(std::memory_order_acquire);
+        uint64_t begin = end > ringSize ? end - ringSize : 0;
+        for (uint64_t i = begin; i < end; i++) {
+            const frameRecord& record = ring[i % ringSize];
+            out << record.frameIndex << ',' << record.total / 1.0e6;
+            for (int p = 0; p < phaseCount; p++)
+                out << ',' << record.phases[p] / 1.0e6;
+            out << '\n';
+        }
+    }
+
+    void shutdown() {
+        if (!enabled)
+            return;
+
+        writeJson(outputPrefix + ".json");
+        writeCsv(outputPrefix + ".csv");
+        std::cout << "Frame time over " << totalHistogram.total << " frames: p50 " << totalHistogram.percentile(50.0) / 1.0e6
+            << " ms, p99 " << totalHistogram.percentile(99.0) / 1.0e6
+            << " ms, max " << totalHistogram.maxValue / 1.0e6
+            << " ms, " << hitches.size() << " hitches" << std::endl;
+    }
+};
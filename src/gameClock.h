@@ -0,0 +1,17 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// Monotonic time in 64-bit integer nanoseconds. Doesn't lose precision over long sessions like a float glfwGetTime() does.
+inline uint64_t nowNanoseconds() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline double nanosecondsToSeconds(uint64_t nanoseconds) {
+    return static_cast<double>(nanoseconds) * 1e-9;
+}
+
+inline uint64_t secondsToNanoseconds(double seconds) {
+    return static_cast<uint64_t>(seconds * 1e9);
+}
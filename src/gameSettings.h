@@ -0,0 +1,187 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Settings that can be changed from the command line, e.g. "PINGPANGTHESECOND.exe --wav-sounds --latency-csv=run1.csv"
+class gameSettings {
+public:
+    bool useWavSounds = false; // play the .wav files in ./sounds instead of the synth
+
+    int simulationRate = 240; // fixed simulation steps per second, independent of the monitor
+    bool simulationThread = true; // simulate on its own thread so a slow swap can't hold up gameplay
+
+    int frameRateLimit = 0;   // 0 = as fast as the swap interval allows
+    int swapInterval = 1;     // 1 = vsync, 0 = off
+    bool idleMenus = true;    // menus sleep until there is input instead of redrawing constantly
+
+    bool measureLatency = false;
+    std::string latencyCsvPath = "latency.csv";
+
+    bool frameStats = false;
+    std::string frameStatsPrefix = "frame_stats"; // writes frame_stats.json and frame_stats.csv
+    double hitchMilliseconds = 25.0;
+
+    bool perfOverlay = false; // CPU/GPU frame time graphs, GPU time per pass, draw calls and triangles
+
+    bool dynamicResolution = false;          // render the scene below native resolution when the GPU can't keep up
+    double dynamicResolutionBudget = 15.0;   // GPU milliseconds per frame to stay under, leaves room for 60 fps
+    float minResolutionScale = 0.5f;
+    float upscaleSharpness = 0.0f;           // 0 = plain bilinear, ~0.2 brings back some edge detail
+
+    bool nullGL = false;           // GL calls are counted instead of executed, no GPU or display needed
+    std::string nullGLLogPath;     // the last gameplay frame's GL calls, one per line
+    uint64_t glCallBudget = 0;     // exit with an error if a gameplay frame makes more GL calls than this
+    int frameLimit = 0;            // quit after this many frames, 0 = run until the window closes
+    bool skipMenu = false;         // start straight in a game
+
+    bool headless = false;         // render offscreen with no window (EGL surfaceless, or OSMesa)
+    int headlessWidth = 1280;
+    int headlessHeight = 720;
+    std::string dumpPrefix;        // headless frames are written to prefix_000123.png
+    int dumpEvery = 1;
+
+    std::string capturePath;       // gameplay is recorded to this .y4m file
+    int captureFps = 60;
+
+    std::string assetPackPath = "assets.pak"; // font and sounds in one mapped file, loose files when it's missing
+    std::string fontCachePath = "fonts/VCR_OSD_MONO_1.001.atlas"; // baked ImGui font atlas, empty = rasterize every run
+    std::string meshDirectory = "meshes"; // ball.obj, paddle.obj, floor.obj and wall.obj here replace the cubes
+    std::string textureDirectory = "textures"; // ball.png, paddle.png, floor.png and wall.png skins, plain colour without
+    double textureUploadMilliseconds = 1.0;    // per frame spent uploading streamed textures, the rest waits a frame
+    int sandboxBalls = 0;          // extra balls bouncing round the arena, 100000 is a good stress test
+    int jobThreads = -1;           // workers for the simulation's systems, -1 = one per core the game isn't using already
+
+    bool checkAllocations = false; // report gameplay frames that call operator new, only in builds with PONG_ALLOCATION_CHECK
+    bool allocationStats = false;  // allocations per frame and subsystem in a window, and in a file at exit
+    std::string allocationStatsPath = "allocation_stats.txt";
+    int allocationSampleEvery = 0; // record the call stack of every Nth allocation, 0 = off
+
+    std::string startupReportPath; // per task startup timings as CSV, the console gets a table either way
+
+    std::string tracePath; // Chrome trace output, only in builds with PONG_PROFILE defined
+
+    // "--name=value" style options
+    static bool readValue(const std::string& arg, const char* name, std::string& value) {
+        std::string prefix = std::string(name) + "=";
+        if (arg.compare(0, prefix.size(), prefix) != 0)
+            return false;
+        value = arg.substr(prefix.size());
+        return true;
+    }
+
+    void parseArgs(int argc, char** argv) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            std::string value;
+
+            if (arg == "--wav-sounds")
+                useWavSounds = true;
+            else if (readValue(arg, "--sim-rate", value)) {
+                int rate = std::atoi(value.c_str());
+                if (rate > 0)
+                    simulationRate = rate;
+            }
+            else if (arg == "--single-thread")
+                simulationThread = false;
+            else if (readValue(arg, "--fps-limit", value))
+                frameRateLimit = std::atoi(value.c_str());
+            else if (readValue(arg, "--swap-interval", value))
+                swapInterval = std::atoi(value.c_str());
+            else if (arg == "--no-idle")
+                idleMenus = false;
+            else if (arg == "--measure-latency")
+                measureLatency = true;
+            else if (readValue(arg, "--latency-csv", value)) {
+                measureLatency = true;
+                latencyCsvPath = value;
+            }
+            else if (arg == "--frame-stats")
+                frameStats = true;
+            else if (readValue(arg, "--frame-stats", value)) {
+                frameStats = true;
+                frameStatsPrefix = value;
+            }
+            else if (readValue(arg, "--hitch-ms", value))
+                hitchMilliseconds = std::atof(value.c_str());
+            else if (arg == "--perf-overlay")
+                perfOverlay = true;
+            else if (arg == "--null-gl")
+                nullGL = true;
+            else if (arg == "--dynamic-res")
+                dynamicResolution = true;
+            else if (readValue(arg, "--dynamic-res", value)) {
+                dynamicResolution = true;
+                double budget = std::atof(value.c_str());
+                if (budget > 0.0)
+                    dynamicResolutionBudget = budget;
+            }
+            else if (readValue(arg, "--min-res-scale", value))
+                minResolutionScale = static_cast<float>(std::atof(value.c_str()));
+            else if (readValue(arg, "--sharpen", value))
+                upscaleSharpness = static_cast<float>(std::atof(value.c_str()));
+            else if (readValue(arg, "--null-gl-log", value)) {
+                nullGL = true;
+                nullGLLogPath = value;
+            }
+            else if (readValue(arg, "--gl-call-budget", value))
+                glCallBudget = std::strtoull(value.c_str(), nullptr, 10);
+            else if (readValue(arg, "--frames", value))
+                frameLimit = std::atoi(value.c_str());
+            else if (arg == "--skip-menu")
+                skipMenu = true;
+            else if (arg == "--headless")
+                headless = true;
+            else if (readValue(arg, "--headless", value)) {
+                headless = true;
+                int width = 0, height = 0;
+                if (std::sscanf(value.c_str(), "%dx%d", &width, &height) == 2 && width > 0 && height > 0) {
+                    headlessWidth = width;
+                    headlessHeight = height;
+                }
+            }
+            else if (readValue(arg, "--dump-frames", value))
+                dumpPrefix = value;
+            else if (readValue(arg, "--dump-every", value))
+                dumpEvery = std::atoi(value.c_str());
+            else if (readValue(arg, "--capture", value))
+                capturePath = value;
+            else if (readValue(arg, "--capture-fps", value))
+                captureFps = std::atoi(value.c_str());
+            else if (readValue(arg, "--asset-pack", value))
+                assetPackPath = value;
+            else if (readValue(arg, "--font-cache", value))
+                fontCachePath = value;
+            else if (arg == "--no-font-cache")
+                fontCachePath.clear();
+            else if (readValue(arg, "--meshes", value))
+                meshDirectory = value;
+            else if (readValue(arg, "--textures", value))
+                textureDirectory = value;
+            else if (readValue(arg, "--texture-upload-ms", value))
+                textureUploadMilliseconds = std::atof(value.c_str());
+            else if (readValue(arg, "--sandbox", value))
+                sandboxBalls = std::atoi(value.c_str());
+            else if (readValue(arg, "--job-threads", value))
+                jobThreads = std::atoi(value.c_str());
+            else if (arg == "--allocation-check")
+                checkAllocations = true;
+            else if (arg == "--allocation-stats")
+                allocationStats = true;
+            else if (readValue(arg, "--allocation-stats", value)) {
+                allocationStats = true;
+                allocationStatsPath = value;
+            }
+            else if (readValue(arg, "--allocation-sample", value))
+                allocationSampleEvery = std::atoi(value.c_str());
+            else if (readValue(arg, "--startup-report", value))
+                startupReportPath = value;
+            else if (readValue(arg, "--trace", value))
+                tracePath = value;
+            else
+                std::cout << "Unknown option: " << arg << std::endl;
+        }
+    }
+};
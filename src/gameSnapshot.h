@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "pongWorld.h"
+
+// Everything the render side needs to draw one simulation step. The simulation publishes one of these
+// every step through a tripleBuffer and never shares anything else with rendering.
+struct gameSnapshot {
+    std::vector<renderInstance> instances[modelCount]; // everything drawn, by model. Refilled in place, so it
+                                                       // stops allocating once a buffer has seen the biggest scene
+    int leftPlayerScore = 0;
+    int rightPlayerScore = 0;
+    int screenOn = 3;
+    bool timed = true;     // countdown before a serve is showing
+    int timerValue = 3;
+    bool wireframeOn = false;
+
+    uint64_t step = 0;      // simulation steps run so far
+    uint64_t stepTime = 0;  // wall clock time this step simulated up to
+    uint64_t pressedAt[4] = {}; // last press of each key latencyTracker follows, for --measure-latency
+};
+
+// Things the render side (menus, ImGui widgets) asks the simulation to do. Applied at the start of the next step.
+enum simulationCommand : unsigned {
+    commandStartGame = 1u << 0,
+    commandPlayAgain = 1u << 1,
+    commandToggleWireframe = 1u << 2,
+};
+
+class simulationCommands {
+public:
+    std::atomic<unsigned> pending{ 0 };
+
+    // any thread
+    void post(simulationCommand command) {
+        pending.fetch_or(command, std::memory_order_release);
+    }
+
+    // simulation thread, everything posted since the last take
+    unsigned take() {
+        return pending.exchange(0, std::memory_order_acquire);
+    }
+};
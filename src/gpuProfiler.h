@@ -0,0 +1,152 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <glad/glad.h>
+#include "imgui.h"
+#include "gameClock.h"
+
+enum gpuPass { gpuPassArena, gpuPassUpscale, gpuPassImGui, gpuPassMenu, gpuPassCount };
+
+// GL_TIME_ELAPSED queries around each render pass. Every frame uses its own set of queries from a
+// pool of framesInFlight sets and reads back the set it is about to reuse, so results arrive a few
+// frames late but we never wait on the GPU. Only needs ARB_timer_query, which Mesa's llvmpipe has too.
+// Enabled with --perf-overlay, or without the overlay when --dynamic-res needs the timings.
+class gpuProfiler {
+public:
+    static const int framesInFlight = 4;
+    static const int historySize = 240;
+
+    bool enabled = false;
+    bool showOverlay = false;
+    GLuint queries[framesInFlight][gpuPassCount] = {};
+    bool issued[framesInFlight][gpuPassCount] = {};
+    int frameSlot = 0;
+    int activePass = -1;
+
+    uint64_t passTime[gpuPassCount] = {}; // latest result for each pass in nanoseconds
+    bool passFresh[gpuPassCount] = {};    // passTime came in this frame
+    uint64_t lastFrameStart = 0;
+
+    int drawCalls = 0;
+    int triangles = 0;
+    int lastDrawCalls = 0;
+    int lastTriangles = 0;
+
+    float cpuHistory[historySize] = {};
+    float gpuHistory[historySize] = {};
+    int historyIndex = 0;
+
+    static const char* passName(int pass) {
+        static const char* names[gpuPassCount] = { "arena", "upscale", "imgui", "menu" };
+        return names[pass];
+    }
+
+    void init(bool enabled, bool showOverlay) {
+        this->enabled = enabled;
+        this->showOverlay = enabled && showOverlay;
+        if (!enabled)
+            return;
+        glGenQueries(framesInFlight * gpuPassCount, &queries[0][0]);
+    }
+
+    void shutdown() {
+        if (!enabled)
+            return;
+        glDeleteQueries(framesInFlight * gpuPassCount, &queries[0][0]);
+        enabled = false;
+    }
+
+    // top of the frame: collect results from the slot we're about to reuse
+    void beginFrame() {
+        if (!enabled)
+            return;
+
+        uint64_t now = nowNanoseconds();
+        float cpuMilliseconds = lastFrameStart != 0 ? static_cast<float>((now - lastFrameStart) / 1.0e6) : 0.0f;
+        lastFrameStart = now;
+
+        frameSlot = (frameSlot + 1) % framesInFlight;
+
+        uint64_t gpuTotal = 0;
+        bool anyResult = false;
+        for (int pass = 0; pass < gpuPassCount; pass++) {
+            passFresh[pass] = false;
+            if (!issued[frameSlot][pass])
+                continue;
+
+            GLuint available = 0;
+            glGetQueryObjectuiv(queries[frameSlot][pass], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                GLuint64 elapsed = 0;
+                glGetQueryObjectui64v(queries[frameSlot][pass], GL_QUERY_RESULT, &elapsed);
+                passTime[pass] = elapsed;
+                passFresh[pass] = true;
+                gpuTotal += elapsed;
+                anyResult = true;
+            }
+            issued[frameSlot][pass] = false;
+        }
+
+        cpuHistory[historyIndex] = cpuMilliseconds;
+        gpuHistory[historyIndex] = anyResult ? static_cast<float>(gpuTotal / 1.0e6) : gpuHistory[(historyIndex + historySize - 1) % historySize];
+        historyIndex = (historyIndex + 1) % historySize;
+
+        lastDrawCalls = drawCalls;
+        lastTriangles = triangles;
+        drawCalls = 0;
+        triangles = 0;
+    }
+
+    // passes can't nest, GL only allows one GL_TIME_ELAPSED query at a time
+    void beginPass(gpuPass pass) {
+        if (!enabled || activePass != -1)
+            return;
+        glBeginQuery(GL_TIME_ELAPSED, queries[frameSlot][pass]);
+        issued[frameSlot][pass] = true;
+        activePass = pass;
+    }
+
+    void endPass() {
+        if (!enabled || activePass == -1)
+            return;
+        glEndQuery(GL_TIME_ELAPSED);
+        activePass = -1;
+    }
+
+    void countDraw(int triangleCount) {
+        drawCalls++;
+        triangles += triangleCount;
+    }
+
+    void countImGui(const ImDrawData* drawData) {
+        if (drawData == nullptr)
+            return;
+        for (int i = 0; i < drawData->CmdListsCount; i++)
+            drawCalls += drawData->CmdLists[i]->CmdBuffer.Size;
+        triangles += drawData->TotalIdxCount / 3;
+    }
+
+    // call inside an ImGui frame
+    void drawOverlay() {
+        if (!showOverlay)
+            return;
+
+        ImGui::SetNextWindowBgAlpha(0.6f);
+        ImGui::SetNextWindowPos(ImVec2(10.0f, 300.0f), ImGuiCond_FirstUseEver);
+        ImGui::Begin("Performance", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings);
+
+        float latestCpu = cpuHistory[(historyIndex + historySize - 1) % historySize];
+        float latestGpu = gpuHistory[(historyIndex + historySize - 1) % historySize];
+
+        char label[64];
+        snprintf(label, sizeof(label), "CPU %.2f ms", latestCpu);
+        ImGui::PlotLines("##cpu", cpuHistory, historySize, historyIndex, label, 0.0f, 33.3f, ImVec2(240.0f, 50.0f));
+        snprintf(label, sizeof(label), "GPU %.2f ms", latestGpu);
+        ImGui::PlotLines("##gpu", gpuHistory, historySize, historyIndex, label, 0.0f, 33.3f, ImVec2(240.0f, 50.0f));
+
+        for (int pass = 0; pass < gpuPassCount; pass++)
+            ImGui::Text("%-7s %6.3f ms", passName(pass), passTime[pass] / 1.0e6);
+        ImGui::Text("%d draw calls, %d triangles", lastDrawCalls, lastTriangles);
+        ImGui::End();
+    }
+};
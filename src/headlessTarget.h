@@ -0,0 +1,98 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <glad/glad.h>
+#include "frameDumper.h"
+#include "pixelReadback.h"
+
+// The framebuffer we draw into when there is no window (--headless). Every dumpEvery frames the picture is
+// read back asynchronously and written as a PNG on the dumper's thread.
+class headlessTarget {
+public:
+    bool enabled = false;
+    int width = 0;
+    int height = 0;
+    GLuint framebuffer = 0;
+    GLuint colorBuffer = 0;
+    GLuint depthBuffer = 0;
+
+    bool dumping = false;
+    int dumpEvery = 1;
+    uint64_t frameIndex = 0;
+    pixelReadback readback;
+    frameDumper dumper;
+
+    bool init(int width, int height, const std::string& dumpPrefix, int dumpEvery) {
+        enabled = true;
+        this->width = width;
+        this->height = height;
+        this->dumpEvery = dumpEvery > 0 ? dumpEvery : 1;
+
+        glGenRenderbuffers(1, &colorBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glGenRenderbuffers(1, &depthBuffer);
+        glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cout << "Headless framebuffer is incomplete" << std::endl;
+            return false;
+        }
+        // stays bound: everything the game draws lands here
+        glViewport(0, 0, width, height);
+
+        if (!dumpPrefix.empty()) {
+            if (!readback.init(width, height, 3)) {
+                std::cout << "Frame dumps need OpenGL 4.4 (persistent mapped buffers)" << std::endl;
+                return false;
+            }
+            dumper.start(&readback, dumpPrefix);
+            dumping = true;
+        }
+        return true;
+    }
+
+    // after the frame is drawn, in place of the swap
+    void endFrame() {
+        if (!enabled)
+            return;
+
+        if (dumping) {
+            auto toDumper = [this](int slot, const uint8_t* pixels, int width, int height, uint64_t index) {
+                dumper.push(slot, pixels, width, height, index);
+            };
+            if (frameIndex % dumpEvery == 0)
+                readback.capture(framebuffer, GL_COLOR_ATTACHMENT0, frameIndex, toDumper);
+            readback.poll(toDumper);
+        }
+        glFlush(); // no swap to push the commands along
+        frameIndex++;
+    }
+
+    void shutdown() {
+        if (!enabled)
+            return;
+
+        if (dumping) {
+            readback.finish([this](int slot, const uint8_t* pixels, int width, int height, uint64_t index) {
+                dumper.push(slot, pixels, width, height, index);
+            });
+            dumper.stop();
+            readback.shutdown();
+            dumping = false;
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteRenderbuffers(1, &colorBuffer);
+        glDeleteRenderbuffers(1, &depthBuffer);
+        enabled = false;
+    }
+};
@@ -0,0 +1,170 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <GLFW/glfw3.h>
+#include "gameClock.h"
+
+struct inputEvent {
+    enum eventType { keyEvent, mouseButtonEvent, cursorEvent };
+
+    eventType type = keyEvent;
+    int key = 0;         // GLFW key or mouse button
+    int action = 0;      // GLFW_PRESS / GLFW_RELEASE
+    double x = 0.0;      // cursor position for cursorEvent
+    double y = 0.0;
+    uint64_t timestamp = 0; // nowNanoseconds() when GLFW delivered the event
+};
+
+// Key, mouse button and cursor transitions recorded by the GLFW callbacks with a timestamp each.
+// Once per frame advance() replays them up to a point in time, so movement can be integrated
+// over exactly how long a key was held instead of "was it down when we polled".
+// The callbacks push on the main thread while advance() may run on the simulation thread, so the ring is locked.
+class inputQueue {
+public:
+    static const int capacity = 256;
+    static const int buttonCount = GLFW_KEY_LAST + 1;
+    static const int mouseButtonOffset = 0; // mouse buttons share the key table, GLFW has no keys below GLFW_KEY_SPACE
+
+    std::mutex eventsLock; // guards events, head, count and dropped
+    inputEvent events[capacity];
+    int head = 0;
+    int count = 0;
+    int dropped = 0;
+    uint64_t eventCount = 0; // every event ever pushed, so others can tell if anything happened
+
+    bool down[buttonCount] = {};
+    uint64_t downSince[buttonCount] = {};
+    uint64_t heldNanoseconds[buttonCount] = {};
+    bool pressed[buttonCount] = {};
+    uint64_t pressedAt[buttonCount] = {}; // raw event timestamp of the last press
+
+    uint64_t intervalStart = 0;
+    uint64_t intervalEnd = 0;
+
+    double cursorX = 0.0;
+    double cursorY = 0.0;
+    double cursorDeltaX = 0.0;
+    double cursorDeltaY = 0.0;
+    bool hasCursor = false;
+
+    void push(const inputEvent& event) {
+        std::lock_guard<std::mutex> lock(eventsLock);
+        eventCount++;
+        if (count == capacity) {
+            dropped++;
+            return;
+        }
+        events[(head + count) % capacity] = event;
+        count++;
+    }
+
+    void pushKey(int key, int action) {
+        if (key < 0 || key >= buttonCount || action == GLFW_REPEAT)
+            return;
+        inputEvent event;
+        event.type = inputEvent::keyEvent;
+        event.key = key;
+        event.action = action;
+        event.timestamp = nowNanoseconds();
+        push(event);
+    }
+
+    void pushMouseButton(int button, int action) {
+        if (button < 0 || button > GLFW_MOUSE_BUTTON_LAST)
+            return;
+        inputEvent event;
+        event.type = inputEvent::mouseButtonEvent;
+        event.key = button;
+        event.action = action;
+        event.timestamp = nowNanoseconds();
+        push(event);
+    }
+
+    void pushCursor(double x, double y) {
+        inputEvent event;
+        event.type = inputEvent::cursorEvent;
+        event.x = x;
+        event.y = y;
+        event.timestamp = nowNanoseconds();
+        push(event);
+    }
+
+    // Replays every event up to 'until'. heldSeconds/wasPressed/cursor delta then describe the interval since the last advance.
+    void advance(uint64_t until) {
+        if (intervalEnd == 0)
+            intervalEnd = until;
+        intervalStart = intervalEnd;
+        intervalEnd = until;
+
+        memset(heldNanoseconds, 0, sizeof(heldNanoseconds));
+        memset(pressed, 0, sizeof(pressed));
+        cursorDeltaX = 0.0;
+        cursorDeltaY = 0.0;
+
+        std::unique_lock<std::mutex> lock(eventsLock);
+        while (count > 0 && events[head].timestamp <= until) {
+            const inputEvent& event = events[head];
+            uint64_t time = event.timestamp < intervalStart ? intervalStart : event.timestamp;
+
+            if (event.type == inputEvent::cursorEvent) {
+                if (hasCursor) {
+                    cursorDeltaX += event.x - cursorX;
+                    cursorDeltaY += event.y - cursorY;
+                }
+                cursorX = event.x;
+                cursorY = event.y;
+                hasCursor = true;
+            }
+            else {
+                int slot = event.type == inputEvent::mouseButtonEvent ? event.key + mouseButtonOffset : event.key;
+                if (event.action == GLFW_PRESS && !down[slot]) {
+                    down[slot] = true;
+                    downSince[slot] = time;
+                    pressed[slot] = true;
+                    pressedAt[slot] = event.timestamp;
+                }
+                else if (event.action == GLFW_RELEASE && down[slot]) {
+                    uint64_t since = downSince[slot] < intervalStart ? intervalStart : downSince[slot];
+                    heldNanoseconds[slot] += time - since;
+                    down[slot] = false;
+                }
+            }
+
+            head = (head + 1) % capacity;
+            count--;
+        }
+        lock.unlock();
+
+        for (int i = 0; i < buttonCount; i++) {
+            if (down[i]) {
+                uint64_t since = downSince[i] < intervalStart ? intervalStart : downSince[i];
+                heldNanoseconds[i] += until - since;
+            }
+        }
+    }
+
+    // seconds the key was held during the last advanced interval
+    float heldSeconds(int key) const {
+        return static_cast<float>(nanosecondsToSeconds(heldNanoseconds[key]));
+    }
+
+    bool wasPressed(int key) const {
+        return pressed[key];
+    }
+
+    bool isDown(int key) const {
+        return down[key];
+    }
+
+    bool wasMouseButtonPressed(int button) const {
+        return pressed[button + mouseButtonOffset];
+    }
+
+    // a new pointer lock shouldn't turn the jump to the window centre into a camera spin
+    void resetCursor() {
+        hasCursor = false;
+        cursorDeltaX = 0.0;
+        cursorDeltaY = 0.0;
+    }
+};
@@ -0,0 +1,279 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "allocationTracker.h"
+#include "profiler.h"
+
+// Work stealing over a fixed set of worker threads, for spreading the simulation's systems across cores.
+//
+//     jobs.start(3);
+//     jobs.parallelFor(chunkCount, 4, [&](int begin, int end) { ... chunks begin to end ... });
+//
+//     jobCounter done;
+//     jobs.submit(a, done);      // jobs the caller owns until the counter says they're finished
+//     jobs.submit(b, done);
+//     jobs.wait(done);           // helps run jobs while it waits, then c can depend on a and b
+//     jobs.submit(c, next);
+//
+// Every thread that submits gets its own Chase-Lev deque: it pushes and pops at the bottom, everyone else steals
+// from the top, so the owner almost never contends. Idle workers sleep on a condition variable. With no workers,
+// parallelFor just runs the whole range on the calling thread, which is what a normal game of pong gets, and so
+// does a submitting thread that comes after every deque has been handed out.
+// One jobSystem per program: threads remember their deque in a thread_local. A job's allocations are charged to the
+// subsystem of the thread that submitted it, whichever thread ends up running it.
+
+class jobCounter {
+public:
+    std::atomic<int> remaining{ 0 }; // the last thing a finishing job touches, so it's safe to go once this is 0
+};
+
+struct job {
+    void (*function)(const job&) = nullptr;
+    const void* data = nullptr;
+    int begin = 0;
+    int end = 0;
+    jobCounter* counter = nullptr;
+    int allocationTag = allocationOther; // the submitter's
+};
+
+// Lê, Pop, Cohen and Zappa Nardelli's C11 version of the Chase-Lev deque, fixed size. A full deque just makes the
+// owner run the job itself.
+class jobDeque {
+public:
+    static const int64_t capacity = 256; // a power of two
+
+    alignas(64) std::atomic<int64_t> top{ 0 };    // thieves and the owner on separate cache lines
+    alignas(64) std::atomic<int64_t> bottom{ 0 };
+    std::atomic<job*> slots[capacity];
+
+    // owner only
+    bool push(job* j) {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        if (b - t >= capacity)
+            return false;
+        slots[b & (capacity - 1)].store(j, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_release); // the job's contents go with it to whoever steals it
+        return true;
+    }
+
+    // owner only, newest first
+    job* pop() {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        job* j = slots[b & (capacity - 1)].load(std::memory_order_relaxed);
+        if (t == b) {
+            // the last one, a thief may be after it too
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                j = nullptr;
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return j;
+    }
+
+    // any thread, oldest first
+    job* steal() {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return nullptr;
+        job* j = slots[t & (capacity - 1)].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return j;
+    }
+};
+
+class jobSystem {
+public:
+    static const int maxThreads = 64;     // workers plus every thread that ever submits
+    static const int maxRanges = 64;      // a parallelFor is cut into at most this many jobs
+    static const int submitterDeques = 4; // kept back from the workers for the main, simulation and render threads
+
+    jobDeque deques[maxThreads];
+    std::atomic<int> dequeCount{ 0 };
+    std::vector<std::thread> workers;
+    std::atomic<int> queued{ 0 };         // pushed and not taken yet, what sleeping workers wait for
+    std::atomic<bool> stopping{ false };
+    std::mutex mutex;
+    std::condition_variable wake;
+
+    ~jobSystem() {
+        stop();
+    }
+
+    void start(int workerCount) {
+        stopping = false;
+        for (int i = 0; i < workerCount && dequeCount < maxThreads - submitterDeques; i++) {
+            int index = dequeCount++;
+            workers.emplace_back([this, index] { workerLoop(index); });
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers)
+            worker.join();
+        workers.clear();
+    }
+
+    int workerCount() const {
+        return static_cast<int>(workers.size());
+    }
+
+    // j stays the caller's until counter drops back to what it was
+    void submit(job& j, jobCounter& counter) {
+        j.counter = &counter;
+        j.allocationTag = allocationTracker::threadTag();
+        counter.remaining.fetch_add(1, std::memory_order_relaxed);
+        int own = workers.empty() ? -1 : myDeque();
+        if (own < 0 || !deques[own].push(&j)) {
+            execute(j);
+            return;
+        }
+        queued.fetch_add(1, std::memory_order_release);
+        wakeWorkers();
+    }
+
+    // runs other jobs until every job submitted with counter has finished
+    void wait(jobCounter& counter) {
+        while (counter.remaining.load(std::memory_order_acquire) != 0) {
+            job* j = findJob(myDeque());
+            if (j != nullptr)
+                execute(*j);
+            else
+                std::this_thread::yield();
+        }
+    }
+
+    // body(begin, end) over 0..count in ranges of about grain, on every thread including this one. Returns once
+    // all of it has run.
+    template <typename F>
+    void parallelFor(int count, int grain, const F& body) {
+        if (count <= 0)
+            return;
+        if (grain < 1)
+            grain = 1;
+        int ranges = (count + grain - 1) / grain;
+        if (ranges > maxRanges) {
+            grain = (count + maxRanges - 1) / maxRanges;
+            ranges = (count + grain - 1) / grain;
+        }
+        int self = ranges == 1 || workers.empty() ? -1 : myDeque();
+        if (self < 0) {
+            body(0, count);
+            return;
+        }
+
+        PROFILE_ZONE("jobSystem::parallelFor");
+        job jobs[maxRanges];
+        jobCounter counter;
+        counter.remaining.store(ranges - 1, std::memory_order_relaxed);
+        jobDeque& own = deques[self];
+        int tag = allocationTracker::threadTag();
+        int pushed = 0;
+        for (int r = 1; r < ranges; r++) {
+            jobs[r].function = &invokeRange<F>;
+            jobs[r].data = &body;
+            jobs[r].begin = r * grain;
+            jobs[r].end = r + 1 < ranges ? (r + 1) * grain : count;
+            jobs[r].counter = &counter;
+            jobs[r].allocationTag = tag;
+            if (own.push(&jobs[r]))
+                pushed++;
+            else
+                execute(jobs[r]);
+        }
+        queued.fetch_add(pushed, std::memory_order_release);
+        wakeWorkers();
+
+        body(0, grain);
+        wait(counter);
+    }
+
+private:
+    template <typename F>
+    static void invokeRange(const job& j) {
+        (*static_cast<const F*>(j.data))(j.begin, j.end);
+    }
+
+    void execute(const job& j) {
+        {
+            ALLOCATION_SCOPE(j.allocationTag);
+            j.function(j);
+        }
+        if (j.counter != nullptr)
+            j.counter->remaining.fetch_sub(1, std::memory_order_release);
+    }
+
+    static int& threadDeque() {
+        thread_local int index = -1;
+        return index;
+    }
+
+    static const jobSystem*& threadOwner() {
+        thread_local const jobSystem* owner = nullptr;
+        return owner;
+    }
+
+    // this thread's deque, claimed the first time it submits anything. -1 when they've all been claimed, the
+    // thread then runs its own jobs straight away.
+    int myDeque() {
+        if (threadOwner() != this) {
+            int index = dequeCount.load();
+            while (index < maxThreads && !dequeCount.compare_exchange_weak(index, index + 1)) {}
+            threadDeque() = index < maxThreads ? index : -1;
+            threadOwner() = this;
+        }
+        return threadDeque();
+    }
+
+    // self is -1 for a thread without a deque, it can only steal
+    job* findJob(int self) {
+        job* j = self >= 0 ? deques[self].pop() : nullptr;
+        int count = dequeCount.load(std::memory_order_relaxed);
+        int first = self >= 0 ? self : 0;
+        for (int i = self >= 0 ? 1 : 0; j == nullptr && i < count; i++)
+            j = deques[(first + i) % count].steal();
+        if (j != nullptr)
+            queued.fetch_sub(1, std::memory_order_relaxed);
+        return j;
+    }
+
+    void wakeWorkers() {
+        // taking the lock means a worker can't be between checking queued and going to sleep
+        { std::lock_guard<std::mutex> lock(mutex); }
+        wake.notify_all();
+    }
+
+    void workerLoop(int self) {
+        threadDeque() = self; // so a job that submits more pushes onto this worker's own deque
+        threadOwner() = this;
+        for (;;) {
+            job* j = findJob(self);
+            if (j != nullptr) {
+                execute(*j);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping.load() || queued.load(std::memory_order_acquire) > 0; });
+            if (stopping)
+                return;
+        }
+    }
+};
@@ -0,0 +1,195 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <glad/glad.h>
+#include "imgui.h"
+#include "gameClock.h"
+#include "hdrHistogram.h"
+#include "inputQueue.h"
+
+// Follows each paddle key press from the GLFW event through simulation, render submit, swap and
+// the GPU finishing that frame (a fence inserted after glfwSwapBuffers). Enabled with --measure-latency.
+class latencyTracker {
+public:
+    static const int maxPendingFrames = 8;
+    static const int maxEventsPerFrame = 4;
+
+    struct trackedEvent {
+        int key = 0;
+        uint64_t inputTime = 0;
+    };
+
+    struct frameInFlight {
+        trackedEvent events[maxEventsPerFrame];
+        int eventCount = 0;
+        uint64_t simulatedTime = 0;
+        uint64_t submittedTime = 0;
+        uint64_t swappedTime = 0;
+        GLsync fence = nullptr;
+    };
+
+    bool enabled = false;
+    const int trackedKeys[maxEventsPerFrame] = { GLFW_KEY_W, GLFW_KEY_S, GLFW_KEY_UP, GLFW_KEY_DOWN };
+
+    frameInFlight current;
+    uint64_t lastSeenPress[maxEventsPerFrame] = {};
+    frameInFlight pending[maxPendingFrames];
+    int pendingHead = 0;
+    int pendingCount = 0;
+
+    hdrHistogram total;       // key press -> GPU finished the frame showing it
+    hdrHistogram toSimulated; // key press -> the step that moved the paddle reached the render side
+    hdrHistogram toSubmitted; // key press -> frame submitted
+    hdrHistogram toSwapped;   // key press -> glfwSwapBuffers returned
+
+    std::ofstream csv;
+
+    void init(bool enabled, const std::string& csvPath) {
+        this->enabled = enabled;
+        if (!enabled)
+            return;
+
+        csv.open(csvPath);
+        if (!csv)
+            std::cout << "Couldn't open " << csvPath << " for latency results" << std::endl;
+        else
+            csv << "key,input_ns,simulated_ns,submitted_ns,swapped_ns,completed_ns,latency_ms\n";
+    }
+
+    void beginFrame() {
+        if (!enabled)
+            return;
+
+        pollFences();
+        current = frameInFlight();
+    }
+
+    // pressedAt is the last press time of each tracked key, as published by the simulation. A time we haven't
+    // seen before is a new press that the frame being built is the first to show.
+    void collectPresses(const uint64_t (&pressedAt)[maxEventsPerFrame]) {
+        if (!enabled)
+            return;
+
+        for (int i = 0; i < maxEventsPerFrame; i++) {
+            if (pressedAt[i] == lastSeenPress[i])
+                continue;
+            lastSeenPress[i] = pressedAt[i];
+            if (current.eventCount < maxEventsPerFrame) {
+                current.events[current.eventCount].key = trackedKeys[i];
+                current.events[current.eventCount].inputTime = pressedAt[i];
+                current.eventCount++;
+            }
+        }
+    }
+
+    void markSimulated() {
+        if (!enabled)
+            return;
+        current.simulatedTime = nowNanoseconds();
+        pollFences();
+    }
+
+    void markSubmitted() {
+        if (!enabled)
+            return;
+        current.submittedTime = nowNanoseconds();
+        pollFences();
+    }
+
+    void markSwapped() {
+        if (!enabled)
+            return;
+        current.swappedTime = nowNanoseconds();
+
+        if (current.eventCount == 0)
+            return;
+
+        if (pendingCount == maxPendingFrames)
+            waitForOldest();
+
+        current.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+        pending[(pendingHead + pendingCount) % maxPendingFrames] = current;
+        pendingCount++;
+    }
+
+    void pollFences() {
+        while (pendingCount > 0) {
+            frameInFlight& frame = pending[pendingHead];
+            GLenum status = glClientWaitSync(frame.fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+                return;
+            complete(frame, nowNanoseconds());
+        }
+    }
+
+    void waitForOldest() {
+        frameInFlight& frame = pending[pendingHead];
+        glClientWaitSync(frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        complete(frame, nowNanoseconds());
+    }
+
+    void complete(frameInFlight& frame, uint64_t completedTime) {
+        for (int i = 0; i < frame.eventCount; i++) {
+            const trackedEvent& event = frame.events[i];
+            total.record(completedTime - event.inputTime);
+            toSimulated.record(frame.simulatedTime - event.inputTime);
+            toSubmitted.record(frame.submittedTime - event.inputTime);
+            toSwapped.record(frame.swappedTime - event.inputTime);
+
+            if (csv) {
+                csv << event.key << ','
+                    << event.inputTime << ','
+                    << frame.simulatedTime << ','
+                    << frame.submittedTime << ','
+                    << frame.swappedTime << ','
+                    << completedTime << ','
+                    << (completedTime - event.inputTime) / 1.0e6 << '\n';
+            }
+        }
+
+        glDeleteSync(frame.fence);
+        frame.fence = nullptr;
+        pendingHead = (pendingHead + 1) % maxPendingFrames;
+        pendingCount--;
+    }
+
+    static void histogramRow(const char* name, const hdrHistogram& histogram) {
+        ImGui::Text("%-10s %7.2f %7.2f %7.2f", name,
+            histogram.percentile(50.0) / 1.0e6,
+            histogram.percentile(95.0) / 1.0e6,
+            histogram.percentile(99.0) / 1.0e6);
+    }
+
+    // call inside an ImGui frame
+    void drawOverlay() {
+        if (!enabled)
+            return;
+
+        ImGui::SetNextWindowBgAlpha(0.6f);
+        ImGui::SetNextWindowPos(ImVec2(10.0f, 80.0f), ImGuiCond_FirstUseEver);
+        ImGui::Begin("Input Latency", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings);
+        ImGui::Text("%llu presses measured", static_cast<unsigned long long>(total.total));
+        ImGui::Text("%-10s %7s %7s %7s", "ms", "p50", "p95", "p99");
+        histogramRow("simulated", toSimulated);
+        histogramRow("submitted", toSubmitted);
+        histogramRow("swapped", toSwapped);
+        histogramRow("on GPU", total);
+        ImGui::End();
+    }
+
+    void shutdown() {
+        if (!enabled)
+            return;
+
+        while (pendingCount > 0)
+            waitForOldest();
+
+        std::cout << "Input latency over " << total.total << " presses: p50 " << total.percentile(50.0) / 1.0e6
+            << " ms, p95 " << total.percentile(95.0) / 1.0e6
+            << " ms, p99 " << total.percentile(99.0) / 1.0e6 << " ms" << std::endl;
+        csv.close();
+    }
+};
@@ -12,13 +12,91 @@
 #include <random>
 #include <chrono>
 #include <thread>
+#include <atomic>
+#include <functional>
 #define MINIAUDIO_IMPLEMENTATION
 #include "miniaudio.h"
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "objLoader/tiny_obj_loader.h"
+#undef TINYOBJLOADER_IMPLEMENTATION // its implementation isn't include guarded, meshImport.h includes it again
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#undef STB_IMAGE_IMPLEMENTATION // same again, textureStreamer.h includes it
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
+#include "gameSettings.h"
+#include "synthVoice.h"
+#include "gameClock.h"
+#include "inputQueue.h"
+#include "latencyTracker.h"
+#include "framePacer.h"
+#include "frameTelemetry.h"
+#include "profiler.h"
+#include "gpuProfiler.h"
+#include "nullGL.h"
+#include "headlessTarget.h"
+#include "dynamicResolution.h"
+#include "gameSnapshot.h"
+#include "tripleBuffer.h"
+#include "videoCapture.h"
+#include "pongPhysics.h"
+#include "shapes.h"
+#include "shaderSources.h"
+#include "scoreOverlay.h"
+#include "fontCache.h"
+#include "menuLayout.h"
+#include "assetPack.h"
+#include "packedSounds.h"
+#include "startupGraph.h"
+#include "meshImport.h"
+#include "pongWorld.h"
+#include "textureStreamer.h"
+#define ALLOCATION_TRACKER_IMPLEMENTATION
+#include "allocationTracker.h"
+#include "allocationCheck.h"
 
 ma_engine engine;
+bool audioStarted = false;          // the engine is up, only read once the startup workers are joined
+std::atomic<bool> audioReady{ false }; // the sounds too, anything played before then is dropped
+gameSettings settings;
+inputQueue input;
+latencyTracker latency;
+frameTelemetry telemetry;
+gpuProfiler gpuTimers;
+nullGL nullBackend;
+headlessTarget headless;
+dynamicResolution dynamicRes;
+videoCapture video;
+scoreHud hud;
+textureStreamer textures;
+jobSystem jobs;
+std::mt19937 serveRandom{ std::random_device{}() }; // the simulation's, for serving. A new seed every run.
+allocationCheck allocations;
+allocationTracker allocationStats;
+
+enum gameSound { soundDink, soundPoint, soundCountdown, soundWin, soundCount };
+
+// also their names in the asset pack
+const char* const soundFiles[soundCount] = {
+    "sounds/dink.wav",
+    "sounds/getPoint.wav",
+    "sounds/countdown.wav",
+    "sounds/win.wav"
+};
+const char* const fontFile = "fonts/VCR_OSD_MONO_1.001.ttf";
+
+assetPack assets;
+fontCache fonts;
+packedSoundBank<soundCount> packedSounds;
+
+synthSoundBank synthSounds;
+synthPatch synthPatches[soundCount] = {
+    synthPatch::dink(),
+    synthPatch::point(),
+    synthPatch::countdown(),
+    synthPatch::win()
+};
 
 // callback functions 
 
@@ -27,8 +105,32 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
     glViewport(0, 0, width, height);
 }
 
-void playSound(const char* soundPath) {
-    ma_engine_play_sound(&engine, soundPath, NULL);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    input.pushKey(key, action);
+}
+
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
+{
+    input.pushMouseButton(button, action);
+}
+
+void cursor_position_callback(GLFWwindow* window, double xpos, double ypos)
+{
+    input.pushCursor(xpos, ypos);
+}
+
+void playSound(gameSound sound) {
+    PROFILE_ZONE("playSound");
+    ALLOCATION_SCOPE(allocationAudio);
+    if (!audioReady.load(std::memory_order_acquire))
+        return;
+    if (settings.useWavSounds && packedSounds.ready)
+        packedSounds.play(sound);
+    else if (settings.useWavSounds)
+        ma_engine_play_sound(&engine, soundFiles[sound], NULL);
+    else
+        synthSounds.play(synthPatches[sound]);
 }
 
 int randomInt(int min, int max) {
@@ -39,12 +141,23 @@ int randomInt(int min, int max) {
     return distr(gen);
 }
 
-float randomFloat(float min, float max) {
-    std::random_device rd; // seed
-    std::mt19937 gen(rd()); // Mersenne Twister RNG
-    std::uniform_real_distribution<float> dis(min, max); // range [0.0, 1.0)
+// debug windows drawn on top of every screen, call before ImGui::Render()
+void drawDebugOverlays() {
+    latency.drawOverlay();
+    gpuTimers.drawOverlay();
+    dynamicRes.drawOverlay(gpuTimers);
+    allocationStats.drawPanel();
+}
 
-    return dis(gen);
+// ends the ImGui frame of a screen and draws it, timed as the given GPU pass
+void renderImGui(gpuPass pass) {
+    drawDebugOverlays();
+    PROFILE_ZONE("ImGui::Render");
+    ImGui::Render();
+    gpuTimers.countImGui(ImGui::GetDrawData());
+    gpuTimers.beginPass(pass);
+    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    gpuTimers.endPass();
 }
 
 float Clamp(float value, float min, float max) {
@@ -60,71 +173,353 @@ public:
     GLFWwindow* window = nullptr;
     int windowWidth = 1920;
     int windowHeight = 1280;
-    float deltaTime = 0.0f; // Time between current and last frame
-    float lastFrame = 0.0f; // Time of last frame
+    float deltaTime = 0.0f; // Time between simulation steps, fixed by settings.simulationRate
+    uint64_t simulationStep = 0; // same thing in nanoseconds
+    uint64_t lastFrame = 0; // Time of last frame in nanoseconds
+    uint64_t accumulator = 0; // real time not yet simulated
+    uint64_t simulationTime = 0; // wall clock time the simulation has caught up to
+    framePacer pacer;
+    bool staticScreen = false; // set by the current screen when nothing moves unless there's input
+    bool loading = true;       // startup tasks or texture uploads still running, the allocation check waits for them
+    int framesRun = 0;
+    bool windowless = false; // null GL or headless: nothing to swap
+    uint64_t firstFrameSwapped = 0;
+    int imguiContextTask = -1;
+    int fontTask = -1;
+
+    // the simulation publishes a snapshot after every step, rendering draws whichever is newest
+    tripleBuffer<gameSnapshot> snapshots;
+    uint64_t stepsRun = 0;
+    int publishedScreen = -1;
+    std::thread simulationThread;
+    std::atomic<bool> simulating{ false };
+
+    // The window, context, audio and asset loading as startup tasks. Main adds ImGui's backends and fonts after
+    // these, depending on imguiContextTask and fontTask.
+    void addStartupTasks(startupGraph& startup) {
+        // no GL, so the font atlas can be baked on a worker while the window is still being created
+        imguiContextTask = startup.add("ImGui context", startupMain, [] {
+            IMGUI_CHECKVERSION();
+            allocationTracker::hookImGui();
+            ImGui::CreateContext();
+            ImGui::StyleColorsDark();
+            ImGui::GetIO().IniFilename = nullptr;
+            return true;
+        });
+        startup.add("window", startupMain, [this] { return createWindow(); });
+        startup.add("GL functions", startupMain, [] {
+            GLADloadproc loader = settings.nullGL ? nullGL::getProcAddress : (GLADloadproc)glfwGetProcAddress;
+            if (!gladLoadGLLoader(loader))
+            {
+                std::cout << "Failed to initialize GLAD" << std::endl;
+                return false;
+            }
+            return true;
+        });
+        startup.add("frame tools", startupMain, [this] { return initFrameTools(); });
+
+        // the font and sounds come out of the pack when there is one, loose files are the fallback
+        int pack = startup.add("asset pack", startupWorker, [] {
+            if (!assets.open(settings.assetPackPath.c_str()))
+                std::cout << "No asset pack at " << settings.assetPackPath << ", loading loose files" << std::endl;
+            return true;
+        });
+        fontTask = startup.add("font file", startupWorker, [] {
+            const assetPackEntry* font = assets.find(fontFile);
+            if (font != nullptr ? !fonts.useMemory(assets.data(font), font->size) : !fonts.loadFile(fontFile))
+                std::cout << "Couldn't load " << fontFile << ", using ImGui's default font and no scores" << std::endl;
+            return true;
+        }, { pack });
+
+        int audio = startup.add("audio device", startupWorker, [] {
+            ma_engine_config config = ma_engine_config_init();
+#ifdef PONG_ALLOCATION_CHECK
+            config.allocationCallbacks.onMalloc = allocationTracker::audioAllocate;
+            config.allocationCallbacks.onRealloc = allocationTracker::audioReallocate;
+            config.allocationCallbacks.onFree = allocationTracker::audioFree;
+#endif
+            if (ma_engine_init(&config, &engine) != MA_SUCCESS) {
+                std::cerr << "Failed to initialize audio engine." << std::endl;
+                return false;
+            }
+            audioStarted = true;
+            return true;
+        });
+        startup.add("sounds", startupWorker, [] {
+            if (!settings.useWavSounds && synthSounds.init(&engine) != 0) {
+                std::cerr << "Failed to initialize synth sounds." << std::endl;
+                return false;
+            }
+            if (settings.useWavSounds && !(assets.isOpen() && packedSounds.init(&engine, assets, soundFiles))) {
+                // loose files, decoded now rather than on their first play
+                ma_resource_manager* manager = ma_engine_get_resource_manager(&engine);
+                for (const char* file : soundFiles)
+                    if (ma_resource_manager_register_file(manager, file, MA_RESOURCE_MANAGER_DATA_SOURCE_FLAG_DECODE) != MA_SUCCESS)
+                        std::cout << "Couldn't decode " << file << std::endl;
+            }
+            audioReady.store(true, std::memory_order_release);
+            return true;
+        }, { audio, pack });
+    }
 
-	int init() {
+    bool createWindow() {
+        // the null backend and headless mode run on GLFW's null platform, no display needed
+        windowless = settings.nullGL || settings.headless;
+        if (windowless)
+            glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
         glfwInit();
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
-        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        if (settings.nullGL) {
+            glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+        }
+        else if (settings.headless) {
+            // surfaceless EGL (or OSMesa below) on llvmpipe, which only goes up to 4.5. That's all we use anyway.
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+            glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+        }
+        else {
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+            glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        }
 
         GLFWmonitor* monitor = glfwGetPrimaryMonitor();
         const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-
-
-        window = glfwCreateWindow(mode->width, mode->height, "PING PANG THE SECOND", monitor, nullptr);
+        windowWidth = mode->width;
+        windowHeight = mode->height;
+        if (settings.headless) {
+            monitor = nullptr;
+            windowWidth = settings.headlessWidth;
+            windowHeight = settings.headlessHeight;
+        }
+        window = glfwCreateWindow(windowWidth, windowHeight, "PING PANG THE SECOND", monitor, nullptr);
+        if (window == NULL && settings.headless) {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+            window = glfwCreateWindow(windowWidth, windowHeight, "PING PANG THE SECOND", nullptr, nullptr);
+        }
         if (window == NULL)
         {
             std::cout << "Failed to create GLFW window" << std::endl;
             glfwTerminate();
-            return -1;
+            return false;
         }
 
-        windowWidth = mode->width;
-        windowHeight = mode->height;
+        if (settings.nullGL) {
+            if (!nullBackend.install()) {
+                glfwTerminate();
+                return false;
+            }
+        }
+        else {
+            glfwMakeContextCurrent(window);
+            if (!windowless)
+                glfwSwapInterval(settings.swapInterval);
+        }
+        pacer.init(settings.frameRateLimit, settings.idleMenus && !windowless);
+        return true;
+    }
 
-        glfwMakeContextCurrent(window);
+    bool initFrameTools() {
+        if (settings.headless && !headless.init(windowWidth, windowHeight, settings.dumpPrefix, settings.dumpEvery))
+            return false;
+        if (!video.init(settings.capturePath, windowWidth, windowHeight, settings.captureFps))
+            return false;
 
-        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-        {
-            std::cout << "Failed to initialize GLAD" << std::endl;
-            return -1;
-        }
+        latency.init(settings.measureLatency, settings.latencyCsvPath);
+        telemetry.init(settings.frameStats, settings.frameStatsPrefix, settings.hitchMilliseconds);
+        allocations.init(settings.checkAllocations);
+        gpuTimers.init(settings.perfOverlay || settings.dynamicResolution, settings.perfOverlay);
+        if (settings.dynamicResolution && !dynamicRes.init(windowWidth, windowHeight, settings.dynamicResolutionBudget,
+            settings.minResolutionScale, settings.upscaleSharpness))
+            return false;
 
         glViewport(0, 0, windowWidth, windowHeight);
         glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        // set before ImGui installs its own callbacks so it chains through to ours
+        glfwSetKeyCallback(window, key_callback);
+        glfwSetMouseButtonCallback(window, mouse_button_callback);
+        glfwSetCursorPosCallback(window, cursor_position_callback);
         glEnable(GL_DEPTH_TEST);
+        return true;
+    }
 
-        IMGUI_CHECKVERSION();
-        ImGui::CreateContext();
-        ImGuiIO& io = ImGui::GetIO(); (void)io;
-        ImGui::StyleColorsDark();
-        ImGui_ImplGlfw_InitForOpenGL(window, true);
-        ImGui_ImplOpenGL3_Init("#version 460");
-        io.IniFilename = nullptr;
+    // after the window's callbacks are set, and after the font atlas is baked so only one thread touches ImGui
+    bool initImGui() {
+        return ImGui_ImplGlfw_InitForOpenGL(window, true) && ImGui_ImplOpenGL3_Init("#version 450");
+    }
 
-        if (ma_engine_init(NULL, &engine) != MA_SUCCESS) {
-            std::cerr << "Failed to initialize audio engine." << std::endl;
-            return -1;
-        }
+    // fills the next snapshot through Publish and hands it to the render side
+    void publishStep(const std::function<void(gameSnapshot&)>& Publish) {
+        gameSnapshot& next = snapshots.writeBuffer();
+        Publish(next);
+        next.step = ++stepsRun;
+        next.stepTime = simulationTime;
+        for (int i = 0; i < latencyTracker::maxEventsPerFrame; i++)
+            next.pressedAt[i] = input.pressedAt[latency.trackedKeys[i]];
+
+        bool screenChanged = next.screenOn != publishedScreen;
+        publishedScreen = next.screenOn;
+        snapshots.publish();
+
+        // a menu may be asleep in glfwWaitEventsTimeout, wake it up to show the new screen
+        if (screenChanged && settings.simulationThread)
+            glfwPostEmptyEvent();
+    }
 
-        return 0;
-	}
+    // --single-thread: run as many steps as real time requires before each frame
+    void catchUp(const std::function<void()>& Input, const std::function<void()>& Simulate, const std::function<void(gameSnapshot&)>& Publish) {
+        const uint64_t maxFrameTime = 250000000ull; // don't try to catch up more than a quarter second after a stall
+        ALLOCATION_SCOPE(allocationSimulation);
 
-    void makeDeltaTime() {
-        float currentFrame = static_cast<float>(glfwGetTime());
-        deltaTime = currentFrame - lastFrame;
+        uint64_t currentFrame = nowNanoseconds();
+        uint64_t frameTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
+
+        if (frameTime > maxFrameTime) {
+            simulationTime += frameTime - maxFrameTime;
+            frameTime = maxFrameTime;
+        }
+        accumulator += frameTime;
+
+        bool stepped = false;
+        while (accumulator >= simulationStep) {
+            simulationTime += simulationStep;
+            {
+                PROFILE_ZONE("Input");
+                frameTelemetry::phaseScope scope(telemetry, phaseInput);
+                input.advance(simulationTime);
+                Input();
+            }
+            {
+                PROFILE_ZONE("Simulate");
+                frameTelemetry::phaseScope scope(telemetry, phaseSimulation);
+                Simulate();
+            }
+            accumulator -= simulationStep;
+            stepped = true;
+        }
+        if (stepped)
+            publishStep(Publish);
     }
 
-    void mainLoop(std::function<void()> Input, std::function<void()> Render) {
+    // the simulation thread: a step every simulationStep of real time, whatever rendering is doing.
+    // Frame telemetry belongs to the render thread, so steps here only show up in the profiler.
+    void simulationLoop(const std::function<void()>& Input, const std::function<void()>& Simulate, const std::function<void(gameSnapshot&)>& Publish) {
+        const uint64_t maxLag = 250000000ull; // same quarter second limit as catchUp
+        ALLOCATION_SCOPE(allocationSimulation);
+        oversleepTracker oversleep; // framePacer's, but sleeping in sleep_for since events belong to the main thread
+
+        while (simulating.load(std::memory_order_acquire)) {
+            uint64_t stepEnd = simulationTime + simulationStep;
+            uint64_t now = nowNanoseconds();
+            if (now < stepEnd) {
+                // sleep most of the way, then yield; the estimate learns how late the OS wakes us
+                uint64_t remaining = stepEnd - now;
+                if (remaining > oversleep.spinTime()) {
+                    uint64_t requested = remaining - oversleep.spinTime();
+                    std::this_thread::sleep_for(std::chrono::nanoseconds(requested));
+                    oversleep.record(requested, nowNanoseconds() - now);
+                }
+                else
+                    std::this_thread::yield();
+                continue;
+            }
+
+            if (now - stepEnd > maxLag)
+                simulationTime += now - stepEnd - maxLag;
+            simulationTime += simulationStep;
+            {
+                PROFILE_ZONE("Input");
+                input.advance(simulationTime);
+                Input();
+            }
+            {
+                PROFILE_ZONE("Simulate");
+                Simulate();
+            }
+            publishStep(Publish);
+        }
+    }
+
+    // Input and Simulate run at a fixed rate, on their own thread unless --single-thread, and Publish copies the
+    // result of each step into a snapshot. Render runs once per swap with the newest snapshot and how far real
+    // time is past that step (0..1) to interpolate with.
+    void mainLoop(std::function<void()> Input, std::function<void()> Simulate,
+        std::function<void(gameSnapshot&)> Publish, std::function<void(const gameSnapshot&, float)> Render) {
+        simulationStep = 1000000000ull / settings.simulationRate;
+        deltaTime = static_cast<float>(nanosecondsToSeconds(simulationStep));
+
+        lastFrame = nowNanoseconds();
+        simulationTime = lastFrame;
+        publishStep(Publish); // so the first frame has something to draw
+
+        if (settings.simulationThread) {
+            simulating.store(true, std::memory_order_release);
+            simulationThread = std::thread([this, &Input, &Simulate, &Publish] { simulationLoop(Input, Simulate, Publish); });
+        }
+
         while (!glfwWindowShouldClose(window))
         {
-            Input();
-            Render();
-            glfwSwapBuffers(window);
+            PROFILE_ZONE("mainLoop");
+            ALLOCATION_SCOPE(allocationRender);
+            allocations.beginFrame();
+            allocationStats.beginFrame();
+            telemetry.beginFrame();
+            gpuTimers.beginFrame();
+            dynamicRes.adjust(gpuTimers);
+            {
+                frameTelemetry::phaseScope scope(telemetry, phaseWait);
+                pacer.waitForNextFrame(staticScreen, input.eventCount);
+            }
+
+            latency.beginFrame();
+            if (!settings.simulationThread)
+                catchUp(Input, Simulate, Publish);
+
+            const gameSnapshot& state = snapshots.read();
+            latency.collectPresses(state.pressedAt);
+            latency.markSimulated();
+
+            {
+                uint64_t now = nowNanoseconds();
+                float alpha = now > state.stepTime ? static_cast<float>(now - state.stepTime) / simulationStep : 0.0f;
+
+                // screens report their scene drawing as phaseRender, everything else they do is ImGui
+                uint64_t sceneBefore = telemetry.current.phases[phaseRender];
+                {
+                    PROFILE_ZONE("Render");
+                    frameTelemetry::phaseScope scope(telemetry, phaseImGui);
+                    Render(state, Clamp(alpha, 0.0f, 1.0f));
+                }
+                telemetry.current.phases[phaseImGui] -= telemetry.current.phases[phaseRender] - sceneBefore;
+            }
+            latency.markSubmitted();
+            {
+                PROFILE_ZONE("glfwSwapBuffers");
+                frameTelemetry::phaseScope scope(telemetry, phaseSwap);
+                if (headless.enabled)
+                    video.captureFrame(headless.framebuffer, GL_COLOR_ATTACHMENT0);
+                else
+                    video.captureFrame(0, GL_BACK);
+                if (!windowless)
+                    glfwSwapBuffers(window);
+                headless.endFrame();
+            }
+            latency.markSwapped();
+            if (firstFrameSwapped == 0)
+                firstFrameSwapped = nowNanoseconds();
+            nullBackend.endFrame(!staticScreen);
+            allocations.endFrame(state.screenOn == 0 && !loading);
             glfwPollEvents();
+
+            if (settings.frameLimit > 0 && ++framesRun >= settings.frameLimit)
+                glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
+
+        if (simulationThread.joinable()) {
+            simulating.store(false, std::memory_order_release);
+            simulationThread.join();
         }
     }
 };
@@ -139,38 +534,19 @@ public:
     unsigned int shaderProgram = 0;
 
     void createVBO(std::vector<float> vertices) {
+        createVBO(vertices.data(), sizeof(float) * vertices.size());
+    }
+
+    void createVBO(const void* vertices, size_t bytes) {
         glGenBuffers(1, &VBO);
 
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
 
-        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(bytes), vertices, GL_STATIC_DRAW);
     }
 
-    int createVertexShader(bool ThreeDs) {
-        std::stringstream ss;
-        if (ThreeDs) {
-            ss << "#version 460 core\n"
-                << "layout (location = 0) in vec3 aPos;\n"
-                << "\n"
-                << "uniform mat4 projection;\n"
-                << "uniform mat4 view;\n"
-                << "uniform mat4 model;\n"
-                << "\n"
-                << "void main()\n"
-                << "{\n"
-                << "    gl_Position = projection * view * model * vec4(aPos, 1.0);\n"
-                << "}";
-        }
-        else {
-            ss << "#version 460 core\n"
-                << "layout (location = 0) in vec3 aPos;\n"
-                << "void main()\n"
-                << "{\n"
-                << "    gl_Position = vec4(aPos.x, aPos.y, aPos.z, 1.0);"
-                << "}";
-        }
-        std::string cool = ss.str();
-        const char* vertexShaderSource = cool.c_str();
+    int createVertexShader(const std::string& source) {
+        const char* vertexShaderSource = source.c_str();
 
         vertexShader = glCreateShader(GL_VERTEX_SHADER);
 
@@ -191,16 +567,8 @@ public:
         return 0;
     }
 
-    int createFragmentShader(float r, float g, float b, float a) {
-        std::stringstream ss;
-        ss << "#version 460 core\n"
-            << "out vec4 FragColor;\n"
-            << "void main()\n"
-            << "{\n"
-            << "    FragColor = vec4(" << r << ", " << g << ", " << b << ", " << a << "); "
-            << "}\n";
-        std::string cool = ss.str();
-        const char* fragmentShaderSource = cool.c_str();
+    int createFragmentShader(const std::string& source) {
+        const char* fragmentShaderSource = source.c_str();
 
         fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
         glShaderSource(fragmentShader, 1, &fragmentShaderSource, NULL);
@@ -267,10 +635,14 @@ public:
     }
 
     void createEBO(std::vector<unsigned int> indices) {
+        createEBO(indices.data(), indices.size() * sizeof(unsigned int));
+    }
+
+    void createEBO(const void* indices, size_t bytes) {
         glGenBuffers(1, &EBO);
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(bytes), indices, GL_STATIC_DRAW);
     }
 
     void cleanUp() {
@@ -281,68 +653,6 @@ public:
     }
 };
 
-class verticesAndIndicesForShapes {
-public:
-    void PositionsForRectangle(std::vector<float>& vertices, std::vector<unsigned int>& indices, float x, float y, float width, float height) {
-        float halfWidth = width / 2;
-        float halfHeight = height / 2;
-        vertices.assign({
-            x + halfWidth,  y + halfHeight, 0.0f,  // top right
-            x + halfWidth, y - halfHeight, 0.0f,   // bottom right
-            x - halfWidth, y - halfHeight, 0.0f,   // bottom left
-            x - halfWidth,  y + halfHeight, 0.0f   // top left 
-        });
-
-        indices.assign({
-            0, 1, 3,
-            1, 2, 3
-        });
-    }
-
-    void PositionsForCube(std::vector<float>& vertices, std::vector<unsigned int>& indices, float x, float y, float z, float width, float height, float depth) {
-        float halfWidth = width / 2;
-        float halfHeight = height / 2;
-        float halfDepth = depth / 2;
-        vertices.assign({
-            x + halfWidth,  y + halfHeight, z - halfDepth,
-            x + halfWidth, y - halfHeight, z - halfDepth,
-            x - halfWidth, y - halfHeight, z - halfDepth,
-            x - halfWidth,  y + halfHeight, z - halfDepth,
-
-            x + halfWidth,  y + halfHeight, z + halfDepth,
-            x + halfWidth, y - halfHeight, z + halfDepth,
-            x - halfWidth, y - halfHeight, z + halfDepth,
-            x - halfWidth,  y + halfHeight, z + halfDepth
-            });
-
-        indices.assign({
-            // Front face (z+)
-            4, 5, 6,
-            4, 6, 7,
-
-            // Back face (z-)
-            0, 3, 2,
-            0, 2, 1,
-
-            // Left face (x-)
-            3, 7, 6,
-            3, 6, 2,
-
-            // Right face (x+)
-            0, 1, 5,
-            0, 5, 4,
-
-            // Top face (y+)
-            0, 4, 7,
-            0, 7, 3,
-
-            // Bottom face (y-)
-            1, 2, 6,
-            1, 6, 5
-            });
-    }
-};
-
 class Camera {
 public:
     GLFWwindow* window = nullptr;
@@ -358,13 +668,6 @@ public:
     glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, 0.0f));
     glm::mat4 view = glm::mat4(1.0f);
 
-    double lastX = 0;
-    double lastY = 0;
-    float yaw = -90.0f;
-    float pitch = 0.0f;
-    bool firstMouse = true;
-    bool cursorLocked = false;
-
     glm::mat4 getProjection() {
         int width, height;
         glfwGetFramebufferSize(window, &width, &height);
@@ -372,87 +675,6 @@ public:
         return glm::perspective(glm::radians(45.0f), aspectRatio, 0.1f, 100.0f);
     }
 
-    void cameraMovement(float deltaTime) {
-        if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS && !cursorLocked) {
-            glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-            cursorLocked = true;
-
-            int width, height;
-            glfwGetWindowSize(window, &width, &height);
-            glfwSetCursorPos(window, width / 2.0, height / 2.0);
-            firstMouse = true;
-        }
-
-        // Unlock on Escape
-        if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS && cursorLocked) {
-            glm::vec3 n = cameraDir;
-            glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
-            cursorLocked = false;
-            cameraDir = n;
-        }
-
-        // Key Movement
-        glm::vec3 forward = glm::normalize(glm::vec3(cameraDir.x, cameraDir.y, cameraDir.z));
-        glm::vec3 right = glm::normalize(glm::cross(forward, cameraUp));
-        float speed = 1.0f * deltaTime;
-
-        if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
-            cameraPos.y += speed;
-
-        if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
-            cameraPos.y -= speed;
-
-        if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
-            cameraPos += forward * speed;
-
-        if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
-            cameraPos -= forward * speed;
-
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
-            cameraPos -= right * speed;
-
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
-            cameraPos += right * speed;
-
-        // Mouse Position Looking
-
-        if (cursorLocked) {
-            double xpos, ypos;
-            glfwGetCursorPos(window, &xpos, &ypos);
-
-            if (firstMouse) {
-                lastX = xpos;
-                lastY = ypos;
-                firstMouse = false;
-            }
-
-            float xoffset = xpos - lastX;
-            float yoffset = lastY - ypos; // Reversed since y-coordinates go from bottom to top
-
-            lastX = xpos;
-            lastY = ypos;
-
-            float sensitivity = 0.1f;
-            xoffset *= sensitivity;
-            yoffset *= sensitivity;
-
-            yaw += xoffset;
-            pitch += yoffset;
-
-            // Clamp pitch
-            if (pitch > 89.0f) pitch = 89.0f;
-            if (pitch < -89.0f) pitch = -89.0f;
-
-            glm::vec3 direction;
-            direction.x = cos(glm::radians(yaw)) * cos(glm::radians(pitch));
-            direction.y = sin(glm::radians(pitch));
-            direction.z = sin(glm::radians(yaw)) * cos(glm::radians(pitch));
-            cameraDir = glm::normalize(direction);
-        }
-
-        view = glm::lookAt(cameraPos, cameraPos + cameraDir, cameraUp);
-    }
-
     void setPosition(glm::vec3 position, glm::vec3 lookAt) {
         view = glm::lookAt(position, lookAt, cameraUp);
     }
@@ -468,795 +690,530 @@ public:
         this->windowWidth = windowWidth;
         this->windowHeight = windowHeight;
 
-        lastX = windowWidth / 2.0f;
-        lastY = windowHeight / 2.0f;
         projection = getProjection();
         view = glm::lookAt(cameraPos, cameraPos + cameraDir, cameraUp);
     }
 };
 
-class renderCube {
+// The GL objects for one kind of thing in the arena, drawn once per frame for every entity that has it as its
+// renderable, all in one instanced draw. The instances come from the snapshot, see renderExtractionSystem.
+class renderModel {
 public:
     basicGraphicalThings BGT;
     verticesAndIndicesForShapes VAIFS;
 
     std::vector<float> vertices;
     std::vector<unsigned int> indices;
+    glm::vec4 color = glm::vec4(1.0f);
+    std::string vertexShaderSource;
+    std::string fragmentShaderSource;
+
+    std::string meshPath; // an .obj to draw instead of the cube, if it's there
+    cachedMesh mesh;      // its cache, mapped from prepare until upload
+    GLsizei indexCount = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    int skin = -1;        // textureStreamer handle, plain colour until it has streamed in
+    GLuint instanceBuffer = 0;
+    GLint alphaLocation = -1;
+
+    // no GL yet, the startup tasks do that
+    void setup(float r, float g, float b, float a) {
+        color = glm::vec4(r, g, b, a);
+    }
 
-    glm::vec3 position;
-    glm::vec3 scale;
+    void setMesh(const std::string& path) {
+        meshPath = path;
+    }
 
-    int setup(float r, float g, float b, float a, glm::vec3 position, glm::vec3 WDH) {
-        this->position = position;
-        scale = WDH;
+    void setSkin(const std::string& path) {
+        skin = textures.request(path);
+    }
 
-        VAIFS.PositionsForCube(vertices, indices, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f);
+    // geometry and shader sources, CPU only so it can run on a startup worker
+    void prepare() {
+        // the mesh cache is mapped and uploaded as it is, the .obj is only parsed when the cache is out of date
+        if (!meshPath.empty() && meshImport::load(meshPath, mesh) && mesh.header->vertexStride != sizeof(float) * 3)
+            mesh.close();
+        if (!mesh.isOpen())
+            VAIFS.PositionsForCube(vertices, indices, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f);
+        vertexShaderSource = buildVertexShaderSource(true);
+        fragmentShaderSource = buildTexturedFragmentShaderSource(color.r, color.g, color.b, color.a);
+    }
 
-        BGT.createVBO(vertices);
-        BGT.createEBO(indices);
+    // the GL objects, on the GL thread after prepare
+    int upload() {
+        if (mesh.isOpen()) {
+            BGT.createVBO(mesh.vertices, cachedMesh::vertexBytes(*mesh.header));
+            BGT.createEBO(mesh.indices, cachedMesh::indexBytes(*mesh.header));
+            indexCount = static_cast<GLsizei>(mesh.header->indexCount);
+            indexType = mesh.header->indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+            mesh.close(); // it's on the GPU now
+        }
+        else {
+            BGT.createVBO(vertices);
+            BGT.createEBO(indices);
+            indexCount = static_cast<GLsizei>(indices.size());
+            indexType = GL_UNSIGNED_INT;
+        }
         BGT.createVAO();
 
-        if (BGT.createVertexShader(true) != 0)
+        // one renderInstance per drawn copy, locations 1 to 3 of the 3D vertex shader
+        glGenBuffers(1, &instanceBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        const size_t offsets[3] = { offsetof(renderInstance, previousPosition), offsetof(renderInstance, position), offsetof(renderInstance, scale) };
+        for (GLuint i = 0; i < 3; i++) {
+            glVertexAttribPointer(i + 1, 3, GL_FLOAT, GL_FALSE, sizeof(renderInstance), reinterpret_cast<void*>(offsets[i]));
+            glEnableVertexAttribArray(i + 1);
+            glVertexAttribDivisor(i + 1, 1);
+        }
+        glBindVertexArray(0);
+
+        if (BGT.createVertexShader(vertexShaderSource) != 0)
             return -1;
-        if (BGT.createFragmentShader(r, g, b, a) != 0)
+        if (BGT.createFragmentShader(fragmentShaderSource) != 0)
             return -1;
         if (BGT.createShaderProgram() != 0)
             return -1;
+        alphaLocation = glGetUniformLocation(BGT.shaderProgram, "alpha");
 
         return 0;
     }
 
-    void render() {
+    // alpha is how far we are between the previous and current simulation step
+    void render(Camera& camera, const std::vector<renderInstance>& instances, float alpha) {
+        PROFILE_ZONE("renderModel::render");
+        if (instances.empty())
+            return;
         glUseProgram(BGT.shaderProgram);
-
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, position);
-        model = glm::scale(model, scale);
-
-        GLuint modelLoc = glGetUniformLocation(BGT.shaderProgram, "model");
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+        camera.setCameraThings(BGT.shaderProgram);
+        glUniform1f(alphaLocation, alpha);
+        textures.bind(skin);
 
         glBindVertexArray(BGT.VAO);
-        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()), GL_UNSIGNED_INT, 0);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(instances.size() * sizeof(renderInstance)), instances.data(), GL_STREAM_DRAW);
+        glDrawElementsInstanced(GL_TRIANGLES, indexCount, indexType, 0, static_cast<GLsizei>(instances.size()));
+        gpuTimers.countDraw(indexCount / 3 * static_cast<int>(instances.size()));
     }
-};
-
-void resetCube(float& speedX, float& speedZ, renderCube& bouncingCube) {
-    bouncingCube.position = glm::vec3(0.0f, -0.575f, 1.25f);
 
-    const float maxSpeed = 2.0f;
-    const float minXSpeed = 0.5f;
-    const float maxXSpeed = 1.5f;
-
-    do {
-        speedX = randomFloat(-maxSpeed, maxSpeed);
-    } while (std::abs(speedX) < minXSpeed || std::abs(speedX) > maxXSpeed);
+    void cleanUp() {
+        BGT.cleanUp();
+        glDeleteBuffers(1, &instanceBuffer);
+    }
+};
 
-    float remainingSpeed = sqrt(maxSpeed * maxSpeed - speedX * speedX);
-    // Randomize direction of speedZ for variety
-    speedZ = (randomFloat(0.0f, 1.0f) > 0.5f) ? remainingSpeed : -remainingSpeed;
+// back to the middle, serving in a new direction
+void resetBall(transform& ball, velocity& speed) {
+    ball = placedAt(glm::vec3(0.0f, -0.575f, 1.25f), ball.scale);
+    serveSpeeds(serveRandom, speed.value.x, speed.value.z);
 }
 
 class mainScreen {
 public:
-    void Input(myCoolOpenGLApp &App, renderCube &LeftPlayer, renderCube &RightPlayer, ImFont* smallFont) {
-        static bool wireframeOn = false;     // Must be static to persist
-        static bool rPressed = false;
-
-        if (glfwGetKey(App.window, GLFW_KEY_W) == GLFW_PRESS)
-            LeftPlayer.position.z += 0.75f * App.deltaTime;
-        if (glfwGetKey(App.window, GLFW_KEY_S) == GLFW_PRESS)
-            LeftPlayer.position.z -= 0.75f * App.deltaTime;
-
-        if (glfwGetKey(App.window, GLFW_KEY_UP) == GLFW_PRESS)
-            RightPlayer.position.z += 0.75f * App.deltaTime;
-        if (glfwGetKey(App.window, GLFW_KEY_DOWN) == GLFW_PRESS)
-            RightPlayer.position.z -= 0.75f * App.deltaTime;
-
-        LeftPlayer.position.z = Clamp(LeftPlayer.position.z, 0.6f, 1.9f);
-        RightPlayer.position.z = Clamp(RightPlayer.position.z, 0.6f, 1.9f);
-
-        if (glfwGetKey(App.window, GLFW_KEY_R) == GLFW_PRESS) {
-            if (!rPressed) {
-                wireframeOn = !wireframeOn;
-                rPressed = true;
-            }
-        }
-        else {
-            rPressed = false;
-        }
-
-        (wireframeOn ? glPolygonMode(GL_FRONT_AND_BACK, GL_LINE) : glPolygonMode(GL_FRONT_AND_BACK, GL_FILL));
+    bool wireframeOn = false;
 
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
-
-        ImGui::SetNextWindowSize(ImVec2(190, 60));
-        ImGui::PushFont(smallFont);
-        ImGui::Begin("Settings");
-        ImGui::Checkbox("Wireframe (Press R)", &wireframeOn);
-        ImGui::PopFont();
-        ImGui::End();
+    bool hasBouncedX = false;
+    bool hasBouncedZ = false;
+    float paddleHitCooldown = 0.0f;
 
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-    }
+    int TimerValue = 3;
+    bool timerStarted = false;
+    float timerElapsed = 0.0f;
 
-    void Render(basicGraphicalThings &BGT, myCoolOpenGLApp &App, Camera &camera, renderCube &backgroundCube, renderCube &TopCube, renderCube &BottomCube, renderCube &RightCube, renderCube &LeftCube, renderCube &BouncingCube, renderCube &LeftPlayer, renderCube &RightPlayer, float &speedX, float &speedZ, ImFont* &bigFont, ImFont* &smallFont, int &leftPlayerScore, int &rightPlayerScore, int &screenOn, bool &Timed) {
-        GLint viewport[4];
-        glGetIntegerv(GL_VIEWPORT, viewport);
+    systemScratch scratch; // the systems', kept so a step doesn't allocate
 
-        if (App.windowWidth != viewport[2] || App.windowHeight != viewport[3]) {
-            App.windowWidth = viewport[2];
-            App.windowHeight = viewport[3];
+    // runs once per simulation step, before Simulate
+    void Input(ecsWorld &world) {
+        const int keys[2][2] = { { GLFW_KEY_W, GLFW_KEY_S }, { GLFW_KEY_UP, GLFW_KEY_DOWN } };
 
-            camera.projection = camera.getProjection();
-            glViewport(0, 0, App.windowWidth, App.windowHeight);
-        }
+        savePositionSystem(world, jobs, scratch);
 
-        App.makeDeltaTime();
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        // integrate over the exact press and release times from the input queue
+        world.each<transform, paddleControl>([&keys](transform& paddle, paddleControl& control) {
+            const int* playerKeys = keys[control.player];
+            paddle.position.z += control.speed * (input.heldSeconds(playerKeys[0]) - input.heldSeconds(playerKeys[1]));
+            paddle.position.z = Clamp(paddle.position.z, control.minZ, control.maxZ);
+        });
 
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
+        if (input.wasPressed(GLFW_KEY_R))
+            wireframeOn = !wireframeOn;
+    }
 
-        static bool hasBouncedX = false;
-        static bool hasBouncedZ = false;
+    // one fixed step of App.deltaTime seconds: countdown, ball movement, collisions and scoring
+    void Simulate(myCoolOpenGLApp &App, ecsWorld &world, const arenaEntities &arena, int &leftPlayerScore, int &rightPlayerScore, int &screenOn, bool &Timed) {
+        PROFILE_ZONE("mainScreen::Simulate");
+        movementSystem(world, jobs, scratch, App.deltaTime);
+        bounceSystem(world, jobs, scratch);
 
-        static int TimerValue = 3;
-        static bool timerStarted = false;
-        static float timerStartTime = 0.0f;
+        transform& BouncingCube = *world.get<transform>(arena.ball);
+        glm::vec3& speed = world.get<velocity>(arena.ball)->value;
+        const transform& LeftPlayer = *world.get<transform>(arena.leftPaddle);
+        const transform& RightPlayer = *world.get<transform>(arena.rightPaddle);
 
         if (Timed) {
             if (!timerStarted) {
-                playSound("./sounds/countdown.wav");
-                timerStartTime = glfwGetTime();
+                playSound(soundCountdown);
+                timerElapsed = 0.0f;
                 timerStarted = true;
-                BouncingCube.position = glm::vec3(0.0f, -0.575f, 1.25f);
+                BouncingCube = placedAt(glm::vec3(0.0f, -0.575f, 1.25f), BouncingCube.scale);
+                speed = glm::vec3(0.0f); // stays put through the countdown
             }
 
-            float currentTime = glfwGetTime();
-            float elapsed = currentTime - timerStartTime;
-            int TimerValue = 3 - floor(elapsed);
+            timerElapsed += App.deltaTime;
+            TimerValue = 3 - static_cast<int>(floor(timerElapsed));
 
             if (TimerValue <= 0) {
-                resetCube(speedX, speedZ, BouncingCube);
+                resetBall(BouncingCube, *world.get<velocity>(arena.ball));
                 Timed = false;
                 timerStarted = false;
                 TimerValue = 3;
             }
-
-            ImGui::SetNextWindowBgAlpha(0.0f); // Fully transparent background
-            ImGui::SetNextWindowPos(ImVec2(0.0f, 100.0f), ImGuiCond_Always);
-            ImGui::Begin("Timer", nullptr,
-                ImGuiWindowFlags_NoTitleBar |
-                ImGuiWindowFlags_NoResize |
-                ImGuiWindowFlags_NoMove |
-                ImGuiWindowFlags_NoScrollbar |
-                ImGuiWindowFlags_NoSavedSettings |
-                ImGuiWindowFlags_NoInputs |
-                ImGuiWindowFlags_NoBackground); // Make it look like just text
-
-            ImGui::PushFont(bigFont);
-            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 0.0f, 1.0f, 1.0f));
-            float textWidth = ImGui::CalcTextSize(std::to_string(TimerValue).c_str()).x;
-
-            ImGui::SetCursorPosX((App.windowWidth - textWidth) * 0.5f); // Center horizontally
-            ImGui::Text("%s", std::to_string(TimerValue).c_str());
-            ImGui::PopStyleColor();
-            ImGui::PopFont();
-            ImGui::End();
+            return;
         }
-        else {
-
-            BouncingCube.position.x += speedX * App.deltaTime;
-            BouncingCube.position.z += speedZ * App.deltaTime;
-
-            bool leftPlayerHit = (
-                BouncingCube.position.x - (BouncingCube.scale.x / 2) < LeftPlayer.position.x + (LeftPlayer.scale.x / 2) &&
-                BouncingCube.position.x + (BouncingCube.scale.x / 2) > LeftPlayer.position.x - (LeftPlayer.scale.x / 2) &&
-                BouncingCube.position.z - (BouncingCube.scale.z / 2) < LeftPlayer.position.z + (LeftPlayer.scale.z / 2) &&
-                BouncingCube.position.z + (BouncingCube.scale.z / 2) > LeftPlayer.position.z - (LeftPlayer.scale.z / 2)
-                );
-
-            bool rightPlayerHit = (
-                BouncingCube.position.x - (BouncingCube.scale.x / 2) < RightPlayer.position.x + (RightPlayer.scale.x / 2) &&
-                BouncingCube.position.x + (BouncingCube.scale.x / 2) > RightPlayer.position.x - (RightPlayer.scale.x / 2) &&
-                BouncingCube.position.z - (BouncingCube.scale.z / 2) < RightPlayer.position.z + (RightPlayer.scale.z / 2) &&
-                BouncingCube.position.z + (BouncingCube.scale.z / 2) > RightPlayer.position.z - (RightPlayer.scale.z / 2)
-                );
-
-            static float paddleHitCooldown = 0.0f;
-            const float paddleHitDelay = 0.1f; // seconds
-
-            if (paddleHitCooldown > 0.0f)
-                paddleHitCooldown -= App.deltaTime;
-
-            if (leftPlayerHit) {
-                if (paddleHitCooldown <= 0.0f) {
-                    playSound("./sounds/dink.wav");
-                    paddleHitCooldown = paddleHitDelay;
-                }
-                    
-                // Calculate overlap for left player separately
-                float overlapXLeft = 0.0f;
-                if (BouncingCube.position.x < LeftPlayer.position.x) {
-                    overlapXLeft = (BouncingCube.position.x + BouncingCube.scale.x / 2) - (LeftPlayer.position.x - LeftPlayer.scale.x / 2);
-                }
-                else {
-                    overlapXLeft = (LeftPlayer.position.x + LeftPlayer.scale.x / 2) - (BouncingCube.position.x - BouncingCube.scale.x / 2);
-                }
 
-                float overlapZLeft = 0.0f;
-                if (BouncingCube.position.z < LeftPlayer.position.z) {
-                    overlapZLeft = (BouncingCube.position.z + BouncingCube.scale.z / 2) - (LeftPlayer.position.z - LeftPlayer.scale.z / 2);
-                }
-                else {
-                    overlapZLeft = (LeftPlayer.position.z + LeftPlayer.scale.z / 2) - (BouncingCube.position.z - BouncingCube.scale.z / 2);
-                }
+        float& speedX = speed.x;
+        float& speedZ = speed.z;
 
-                // Reflect speeds based on which overlap is smaller (collision axis)
-                if (overlapXLeft < overlapZLeft && speedX > 0 && !hasBouncedX) {  // The cube is moving towards the left player (speedX > 0)
-                    (speedX > 0 ? speedX += 0.1f : speedX -= 0.1f);
-                    speedX = -speedX;
-                    hasBouncedX = true;
-                }
-                else if (overlapZLeft < overlapXLeft && !hasBouncedZ) {
-                    (speedZ > 0 ? speedZ += 0.1f : speedZ -= 0.1f);
-                    speedZ = -speedZ;
-                    hasBouncedZ = true;
-                }
-            }
+        bool leftPlayerHit = cubesOverlap(BouncingCube.position, BouncingCube.scale, LeftPlayer.position, LeftPlayer.scale);
+        bool rightPlayerHit = cubesOverlap(BouncingCube.position, BouncingCube.scale, RightPlayer.position, RightPlayer.scale);
 
-            if (rightPlayerHit) {
-                if (paddleHitCooldown <= 0.0f) {
-                    playSound("./sounds/dink.wav");
-                    paddleHitCooldown = paddleHitDelay;
-                }
-                    
-                // Calculate overlap for right player separately
-                float overlapXRight = 0.0f;
-                if (BouncingCube.position.x < RightPlayer.position.x) {
-                    overlapXRight = (BouncingCube.position.x + BouncingCube.scale.x / 2) - (RightPlayer.position.x - RightPlayer.scale.x / 2);
-                }
-                else {
-                    overlapXRight = (RightPlayer.position.x + RightPlayer.scale.x / 2) - (BouncingCube.position.x - BouncingCube.scale.x / 2);
-                }
+        const float paddleHitDelay = 0.1f; // seconds
 
-                float overlapZRight = 0.0f;
-                if (BouncingCube.position.z < RightPlayer.position.z) {
-                    overlapZRight = (BouncingCube.position.z + BouncingCube.scale.z / 2) - (RightPlayer.position.z - RightPlayer.scale.z / 2);
-                }
-                else {
-                    overlapZRight = (RightPlayer.position.z + RightPlayer.scale.z / 2) - (BouncingCube.position.z - BouncingCube.scale.z / 2);
-                }
+        if (paddleHitCooldown > 0.0f)
+            paddleHitCooldown -= App.deltaTime;
 
-                if (overlapXRight < overlapZRight && speedX < 0 && !hasBouncedX) {  // Moving toward right player
-                    (speedX > 0 ? speedX += 0.1f : speedX -= 0.1f);
-                    speedX = -speedX;
-                    hasBouncedX = true;
-                }
-                else if (overlapZRight < overlapXRight && !hasBouncedZ) {
-                    (speedZ > 0 ? speedZ += 0.1f : speedZ -= 0.1f);
-                    speedZ = -speedZ;
-                    hasBouncedZ = true;
-                }
+        if (leftPlayerHit) {
+            if (paddleHitCooldown <= 0.0f) {
+                playSound(soundDink);
+                paddleHitCooldown = paddleHitDelay;
             }
 
-            if (!leftPlayerHit && !rightPlayerHit) {
-                hasBouncedX = false;
-                hasBouncedZ = false;
-            }
-
-            // Calculate overlaps on Z axis
-
-            if (BouncingCube.position.z > 1.975f && speedZ > 0) {
-                speedZ = -speedZ;
-            }
-            if (BouncingCube.position.z < 0.525f && speedZ < 0) {
-                speedZ = -speedZ;
-            }
-
-            if (BouncingCube.position.x < -1.225) {
-                leftPlayerScore++;
-                Timed = true;
-                playSound("./sounds/getPoint.wav");
-            }
+            // The cube is moving towards the left player when speedX > 0
+            paddleBounce(BouncingCube.position, BouncingCube.scale, LeftPlayer.position, LeftPlayer.scale,
+                speedX > 0, speedX, speedZ, hasBouncedX, hasBouncedZ);
+        }
 
-            if (BouncingCube.position.x > 1.225) {
-                rightPlayerScore++;
-                Timed = true;
-                playSound("./sounds/getPoint.wav");
+        if (rightPlayerHit) {
+            if (paddleHitCooldown <= 0.0f) {
+                playSound(soundDink);
+                paddleHitCooldown = paddleHitDelay;
             }
 
-            if (leftPlayerScore > 8) {
-                screenOn = 1;
-                playSound("./sounds/win.wav");
-            }
-                
-            if (rightPlayerScore > 8) {
-                screenOn = 2;
-                playSound("./sounds/win.wav");
-            }
+            paddleBounce(BouncingCube.position, BouncingCube.scale, RightPlayer.position, RightPlayer.scale,
+                speedX < 0, speedX, speedZ, hasBouncedX, hasBouncedZ);
         }
 
-        backgroundCube.render();
-        camera.setCameraThings(backgroundCube.BGT.shaderProgram);
-        TopCube.render();
-        camera.setCameraThings(TopCube.BGT.shaderProgram);
-        BottomCube.render();
-        camera.setCameraThings(BottomCube.BGT.shaderProgram);
-        RightCube.render();
-        camera.setCameraThings(RightCube.BGT.shaderProgram);
-        LeftCube.render();
-        camera.setCameraThings(LeftCube.BGT.shaderProgram);
-        BouncingCube.render();
-        camera.setCameraThings(BouncingCube.BGT.shaderProgram);
-        RightPlayer.render();
-        camera.setCameraThings(RightPlayer.BGT.shaderProgram);
-        LeftPlayer.render();
-        camera.setCameraThings(LeftPlayer.BGT.shaderProgram);
-
-        ImGui::SetNextWindowBgAlpha(0.0f); // Fully transparent background
-        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f), ImGuiCond_Always);
-        ImGui::SetNextWindowSize(ImVec2(App.windowWidth, App.windowHeight)); // Fullscreen
-        ImGui::Begin("OverlayLeft", nullptr,
-            ImGuiWindowFlags_NoTitleBar |
-            ImGuiWindowFlags_NoResize |
-            ImGuiWindowFlags_NoMove |
-            ImGuiWindowFlags_NoScrollbar |
-            ImGuiWindowFlags_NoSavedSettings |
-            ImGuiWindowFlags_NoInputs |
-            ImGuiWindowFlags_NoBackground); // Make it look like just text
-
-        ImGui::PushFont(bigFont);
-        ImGui::PushStyleColor(ImGuiCol_Text, IM_COL32(255, 255, 0, 255)); // Red color (RGBA)
-
-        ImVec2 textSizeLeft = ImGui::CalcTextSize(std::to_string(leftPlayerScore).c_str());
-
-        ImGui::SetCursorPos(ImVec2(
-            ((App.windowWidth - textSizeLeft.x) * 0.5f) - 200.0f,
-            150.0f
-        ));
-        ImGui::Text("%s", std::to_string(leftPlayerScore).c_str());
-
-        ImGui::PopStyleColor();
-        ImGui::PopFont();
-        ImGui::End();
-
-        ImGui::SetNextWindowBgAlpha(0.0f); // Fully transparent background
-        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f), ImGuiCond_Always);
-        ImGui::SetNextWindowSize(ImVec2(App.windowWidth, App.windowHeight)); // Fullscreen
-        ImGui::Begin("OverlayRight", nullptr,
-            ImGuiWindowFlags_NoTitleBar |
-            ImGuiWindowFlags_NoResize |
-            ImGuiWindowFlags_NoMove |
-            ImGuiWindowFlags_NoScrollbar |
-            ImGuiWindowFlags_NoSavedSettings |
-            ImGuiWindowFlags_NoInputs |
-            ImGuiWindowFlags_NoBackground); // Make it look like just text
-
-        ImGui::PushFont(bigFont);
-        ImGui::PushStyleColor(ImGuiCol_Text, IM_COL32(255, 255, 0, 255)); // Red color (RGBA)
-        
-        ImVec2 textSizeRight = ImGui::CalcTextSize(std::to_string(rightPlayerScore).c_str());
-
-        ImGui::SetCursorPos(ImVec2(
-            ((App.windowWidth - textSizeRight.x) * 0.5f) + 200.0f,
-            150.0f
-        ));
-        ImGui::Text("%s", std::to_string(rightPlayerScore).c_str());
-
-        ImGui::PopStyleColor();
-        ImGui::PopFont();
-        ImGui::End();
-
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-    }
-};
-
-class startScreen {
-public:
-    void Render(myCoolOpenGLApp &App, ImFont* &bigFont, ImFont* &mediumFont, int &screenOn) {
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
-
-        ImGui::SetNextWindowSize(ImVec2(App.windowWidth, App.windowHeight));
-        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f), ImGuiCond_Always);
-        ImGui::Begin("Main Screen", nullptr,
-            ImGuiWindowFlags_NoTitleBar |
-            ImGuiWindowFlags_NoResize |
-            ImGuiWindowFlags_NoMove |
-            ImGuiWindowFlags_NoScrollbar |
-            ImGuiWindowFlags_NoSavedSettings |
-            ImGuiWindowFlags_NoInputs); // Make it look like just text
-        ImGui::End();
-
-        ImGui::SetNextWindowBgAlpha(0.0f); // Fully transparent background
-        ImGui::SetNextWindowPos(ImVec2(0.0f, 100.0f), ImGuiCond_Always);
-        ImGui::Begin("Title", nullptr,
-            ImGuiWindowFlags_NoTitleBar |
-            ImGuiWindowFlags_NoResize |
-            ImGuiWindowFlags_NoMove |
-            ImGuiWindowFlags_NoScrollbar |
-            ImGuiWindowFlags_NoSavedSettings |
-            ImGuiWindowFlags_NoInputs |
-            ImGuiWindowFlags_NoBackground); // Make it look like just text
-
-        ImGui::PushFont(bigFont);
-        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
-        const char* text = "PING PANG THE SECOND";
-        float textWidth = ImGui::CalcTextSize(text).x;
-
-        ImGui::SetCursorPosX((App.windowWidth - textWidth) * 0.5f); // Center horizontally
-        ImGui::Text("%s", text);
-        ImGui::PopStyleColor();
-        ImGui::PopFont();
-
-        ImGui::End();
-
-        ImGui::SetNextWindowBgAlpha(0.0f); // Fully transparent background
-        ImGui::SetNextWindowPos(ImVec2(0.0f, App.windowHeight / 2), ImGuiCond_Always);
-        ImGui::Begin("Start Button", nullptr,
-            ImGuiWindowFlags_NoTitleBar |
-            ImGuiWindowFlags_NoResize |
-            ImGuiWindowFlags_NoMove |
-            ImGuiWindowFlags_NoScrollbar |
-            ImGuiWindowFlags_NoSavedSettings |
-            ImGuiWindowFlags_NoBackground); // Make it look like just text
-
-        ImGui::PushFont(mediumFont);
-        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
-        float buttonWidth = 500;
-
-        ImGui::SetCursorPosX((App.windowWidth - buttonWidth) * 0.5f); // Center horizontally
-        if (ImGui::Button("Start Game", ImVec2(buttonWidth, 100))) {
-            screenOn = 0;
+        if (!leftPlayerHit && !rightPlayerHit) {
+            hasBouncedX = false;
+            hasBouncedZ = false;
         }
-        ImVec2 p = ImGui::GetItemRectMin(); // Top-left of last item (button)
-        ImVec2 q = ImGui::GetItemRectMax(); // Bottom-right of last item
-
-        ImGui::GetWindowDrawList()->AddRect(p, q, IM_COL32(0, 255, 0, 255), 0.0f, 0, 5.0f);
-
-        ImGui::PopStyleColor();
-        ImGui::PopFont();
 
-        ImGui::End();
+        // Calculate overlaps on Z axis
 
-        ImGui::SetNextWindowBgAlpha(0.0f); // Fully transparent background
-        ImGui::SetNextWindowPos(ImVec2(0.0f, (App.windowHeight / 2) + 120), ImGuiCond_Always);
-        ImGui::Begin("Quit Button", nullptr,
-            ImGuiWindowFlags_NoTitleBar |
-            ImGuiWindowFlags_NoResize |
-            ImGuiWindowFlags_NoMove |
-            ImGuiWindowFlags_NoScrollbar |
-            ImGuiWindowFlags_NoSavedSettings |
-            ImGuiWindowFlags_NoBackground); // Make it look like just text
-
-        ImGui::PushFont(mediumFont);
-        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
-        float buttonWidthQuit = 500;
-
-        ImGui::SetCursorPosX((App.windowWidth - buttonWidthQuit) * 0.5f); // Center horizontally
-        if (ImGui::Button("Quit Game", ImVec2(buttonWidthQuit, 100))) {
-            glfwSetWindowShouldClose(App.window, GL_TRUE);
+        if (BouncingCube.position.z > 1.975f && speedZ > 0) {
+            speedZ = -speedZ;
+        }
+        if (BouncingCube.position.z < 0.525f && speedZ < 0) {
+            speedZ = -speedZ;
         }
-        ImVec2 pQuit = ImGui::GetItemRectMin(); // Top-left of last item (button)
-        ImVec2 qQuit = ImGui::GetItemRectMax(); // Bottom-right of last item
 
-        ImGui::GetWindowDrawList()->AddRect(pQuit, qQuit, IM_COL32(0, 255, 0, 255), 0.0f, 0, 5.0f);
+        if (BouncingCube.position.x < -1.225) {
+            leftPlayerScore++;
+            Timed = true;
+            playSound(soundPoint);
+        }
 
-        ImGui::PopStyleColor();
-        ImGui::PopFont();
+        if (BouncingCube.position.x > 1.225) {
+            rightPlayerScore++;
+            Timed = true;
+            playSound(soundPoint);
+        }
 
-        ImGui::End();
+        if (leftPlayerScore > 8) {
+            screenOn = 1;
+            playSound(soundWin);
+        }
 
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        if (rightPlayerScore > 8) {
+            screenOn = 2;
+            playSound(soundWin);
+        }
     }
-};
 
-class leftPlayerWins {
-public:
-    void Render(myCoolOpenGLApp& App, ImFont*& bigFont, ImFont*& mediumFont, int& screenOn, int &leftPlayerScore, int &rightPlayerScore, float& speedX, float& speedZ, renderCube& bouncingCube) {
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
-
-        ImGui::SetNextWindowSize(ImVec2(App.windowWidth, App.windowHeight));
-        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f), ImGuiCond_Always);
-        ImGui::Begin("Main Screen", nullptr,
-            ImGuiWindowFlags_NoTitleBar |
-            ImGuiWindowFlags_NoResize |
-            ImGuiWindowFlags_NoMove |
-            ImGuiWindowFlags_NoScrollbar |
-            ImGuiWindowFlags_NoSavedSettings |
-            ImGuiWindowFlags_NoInputs); // Make it look like just text
-        ImGui::End();
+    // once per swap, alpha is how far we are between the last two simulation steps
+    void Render(myCoolOpenGLApp &App, Camera &camera, renderModel (&models)[modelCount], ImFont* &smallFont, const gameSnapshot &state, simulationCommands &commands, float alpha) {
+        PROFILE_ZONE("mainScreen::Render");
 
-        ImGui::SetNextWindowBgAlpha(0.0f); // Fully transparent background
-        ImGui::SetNextWindowPos(ImVec2(0.0f, 100.0f), ImGuiCond_Always);
-        ImGui::Begin("Title", nullptr,
-            ImGuiWindowFlags_NoTitleBar |
-            ImGuiWindowFlags_NoResize |
-            ImGuiWindowFlags_NoMove |
-            ImGuiWindowFlags_NoScrollbar |
-            ImGuiWindowFlags_NoSavedSettings |
-            ImGuiWindowFlags_NoInputs |
-            ImGuiWindowFlags_NoBackground); // Make it look like just text
-
-        ImGui::PushFont(bigFont);
-        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
-        const char* text = "Left Player Wins!";
-        float textWidth = ImGui::CalcTextSize(text).x;
-
-        ImGui::SetCursorPosX((App.windowWidth - textWidth) * 0.5f); // Center horizontally
-        ImGui::Text("%s", text);
-        ImGui::PopStyleColor();
-        ImGui::PopFont();
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
 
-        ImGui::End();
+        if (App.windowWidth != viewport[2] || App.windowHeight != viewport[3]) {
+            App.windowWidth = viewport[2];
+            App.windowHeight = viewport[3];
 
-        ImGui::SetNextWindowBgAlpha(0.0f); // Fully transparent background
-        ImGui::SetNextWindowPos(ImVec2(0.0f, App.windowHeight / 2), ImGuiCond_Always);
-        ImGui::Begin("Play Again", nullptr,
-            ImGuiWindowFlags_NoTitleBar |
-            ImGuiWindowFlags_NoResize |
-            ImGuiWindowFlags_NoMove |
-            ImGuiWindowFlags_NoScrollbar |
-            ImGuiWindowFlags_NoSavedSettings |
-            ImGuiWindowFlags_NoBackground); // Make it look like just text
-
-        ImGui::PushFont(mediumFont);
-        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
-        float buttonWidth = 500;
-
-        ImGui::SetCursorPosX((App.windowWidth - buttonWidth) * 0.5f); // Center horizontally
-        if (ImGui::Button("Play Again", ImVec2(buttonWidth, 100))) {
-            screenOn = 0;
-            leftPlayerScore = 0;
-            rightPlayerScore = 0;
-            resetCube(speedX, speedZ, bouncingCube);
+            camera.projection = camera.getProjection();
+            glViewport(0, 0, App.windowWidth, App.windowHeight);
         }
-        ImVec2 p = ImGui::GetItemRectMin(); // Top-left of last item (button)
-        ImVec2 q = ImGui::GetItemRectMax(); // Bottom-right of last item
 
-        ImGui::GetWindowDrawList()->AddRect(p, q, IM_COL32(0, 255, 0, 255), 0.0f, 0, 5.0f);
+        {
+            frameTelemetry::phaseScope sceneScope(telemetry, phaseRender);
+            dynamicRes.beginScene(App.windowWidth, App.windowHeight);
+            gpuTimers.beginPass(gpuPassArena);
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        ImGui::PopStyleColor();
-        ImGui::PopFont();
+            (state.wireframeOn ? glPolygonMode(GL_FRONT_AND_BACK, GL_LINE) : glPolygonMode(GL_FRONT_AND_BACK, GL_FILL));
 
-        ImGui::End();
+            for (int model = 0; model < modelCount; model++)
+                models[model].render(camera, state.instances[model], alpha);
 
-        ImGui::SetNextWindowBgAlpha(0.0f); // Fully transparent background
-        ImGui::SetNextWindowPos(ImVec2(0.0f, (App.windowHeight / 2) + 120), ImGuiCond_Always);
-        ImGui::Begin("Quit Button", nullptr,
-            ImGuiWindowFlags_NoTitleBar |
-            ImGuiWindowFlags_NoResize |
-            ImGuiWindowFlags_NoMove |
-            ImGuiWindowFlags_NoScrollbar |
-            ImGuiWindowFlags_NoSavedSettings |
-            ImGuiWindowFlags_NoBackground); // Make it look like just text
-
-        ImGui::PushFont(mediumFont);
-        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
-        float buttonWidthQuit = 500;
-
-        ImGui::SetCursorPosX((App.windowWidth - buttonWidthQuit) * 0.5f); // Center horizontally
-        if (ImGui::Button("Quit Game", ImVec2(buttonWidthQuit, 100))) {
-            glfwSetWindowShouldClose(App.window, GL_TRUE);
+            glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+            gpuTimers.endPass();
+            dynamicRes.endScene(gpuTimers);
         }
-        ImVec2 pQuit = ImGui::GetItemRectMin(); // Top-left of last item (button)
-        ImVec2 qQuit = ImGui::GetItemRectMax(); // Bottom-right of last item
-
-        ImGui::GetWindowDrawList()->AddRect(pQuit, qQuit, IM_COL32(0, 255, 0, 255), 0.0f, 0, 5.0f);
 
-        ImGui::PopStyleColor();
-        ImGui::PopFont();
-
-        ImGui::End();
-
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-    }
-};
+        // full resolution, after the upscale
+        gpuTimers.countDraw(hud.draw(state.leftPlayerScore, state.rightPlayerScore, state.timed, state.timerValue,
+            static_cast<float>(App.windowWidth), static_cast<float>(App.windowHeight)));
 
-class rightPlayerWins {
-public:
-    void Render(myCoolOpenGLApp& App, ImFont*& bigFont, ImFont*& mediumFont, int& screenOn, int& leftPlayerScore, int& rightPlayerScore, float& speedX, float& speedZ, renderCube& bouncingCube) {
+        ALLOCATION_SCOPE(allocationUI);
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
-        ImGui::SetNextWindowSize(ImVec2(App.windowWidth, App.windowHeight));
-        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f), ImGuiCond_Always);
-        ImGui::Begin("Main Screen", nullptr,
-            ImGuiWindowFlags_NoTitleBar |
-            ImGuiWindowFlags_NoResize |
-            ImGuiWindowFlags_NoMove |
-            ImGuiWindowFlags_NoScrollbar |
-            ImGuiWindowFlags_NoSavedSettings |
-            ImGuiWindowFlags_NoInputs); // Make it look like just text
-        ImGui::End();
-
-        ImGui::SetNextWindowBgAlpha(0.0f); // Fully transparent background
-        ImGui::SetNextWindowPos(ImVec2(0.0f, 100.0f), ImGuiCond_Always);
-        ImGui::Begin("Title", nullptr,
-            ImGuiWindowFlags_NoTitleBar |
-            ImGuiWindowFlags_NoResize |
-            ImGuiWindowFlags_NoMove |
-            ImGuiWindowFlags_NoScrollbar |
-            ImGuiWindowFlags_NoSavedSettings |
-            ImGuiWindowFlags_NoInputs |
-            ImGuiWindowFlags_NoBackground); // Make it look like just text
-
-        ImGui::PushFont(bigFont);
-        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
-        const char* text = "Right Player Wins!";
-        float textWidth = ImGui::CalcTextSize(text).x;
-
-        ImGui::SetCursorPosX((App.windowWidth - textWidth) * 0.5f); // Center horizontally
-        ImGui::Text("%s", text);
-        ImGui::PopStyleColor();
-        ImGui::PopFont();
-
-        ImGui::End();
-
-        ImGui::SetNextWindowBgAlpha(0.0f); // Fully transparent background
-        ImGui::SetNextWindowPos(ImVec2(0.0f, App.windowHeight / 2), ImGuiCond_Always);
-        ImGui::Begin("Play Again", nullptr,
-            ImGuiWindowFlags_NoTitleBar |
-            ImGuiWindowFlags_NoResize |
-            ImGuiWindowFlags_NoMove |
-            ImGuiWindowFlags_NoScrollbar |
-            ImGuiWindowFlags_NoSavedSettings |
-            ImGuiWindowFlags_NoBackground); // Make it look like just text
-
-        ImGui::PushFont(mediumFont);
-        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
-        float buttonWidth = 500;
-
-        ImGui::SetCursorPosX((App.windowWidth - buttonWidth) * 0.5f); // Center horizontally
-        if (ImGui::Button("Play Again", ImVec2(buttonWidth, 100))) {
-            screenOn = 0;
-            leftPlayerScore = 0;
-            rightPlayerScore = 0;
-            resetCube(speedX, speedZ, bouncingCube);
-        }
-        ImVec2 p = ImGui::GetItemRectMin(); // Top-left of last item (button)
-        ImVec2 q = ImGui::GetItemRectMax(); // Bottom-right of last item
-
-        ImGui::GetWindowDrawList()->AddRect(p, q, IM_COL32(0, 255, 0, 255), 0.0f, 0, 5.0f);
-
-        ImGui::PopStyleColor();
-        ImGui::PopFont();
-
-        ImGui::End();
-
-        ImGui::SetNextWindowBgAlpha(0.0f); // Fully transparent background
-        ImGui::SetNextWindowPos(ImVec2(0.0f, (App.windowHeight / 2) + 120), ImGuiCond_Always);
-        ImGui::Begin("Quit Button", nullptr,
-            ImGuiWindowFlags_NoTitleBar |
-            ImGuiWindowFlags_NoResize |
-            ImGuiWindowFlags_NoMove |
-            ImGuiWindowFlags_NoScrollbar |
-            ImGuiWindowFlags_NoSavedSettings |
-            ImGuiWindowFlags_NoBackground); // Make it look like just text
-
-        ImGui::PushFont(mediumFont);
-        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(1.0f, 1.0f, 1.0f, 1.0f));
-        float buttonWidthQuit = 500;
-
-        ImGui::SetCursorPosX((App.windowWidth - buttonWidthQuit) * 0.5f); // Center horizontally
-        if (ImGui::Button("Quit Game", ImVec2(buttonWidthQuit, 100))) {
-            glfwSetWindowShouldClose(App.window, GL_TRUE);
-        }
-        ImVec2 pQuit = ImGui::GetItemRectMin(); // Top-left of last item (button)
-        ImVec2 qQuit = ImGui::GetItemRectMax(); // Bottom-right of last item
-
-        ImGui::GetWindowDrawList()->AddRect(pQuit, qQuit, IM_COL32(0, 255, 0, 255), 0.0f, 0, 5.0f);
-
-        ImGui::PopStyleColor();
+        ImGui::SetNextWindowSize(ImVec2(190, 60));
+        ImGui::PushFont(smallFont);
+        ImGui::Begin("Settings");
+        bool wireframe = state.wireframeOn;
+        if (ImGui::Checkbox("Wireframe (Press R)", &wireframe))
+            commands.post(commandToggleWireframe);
         ImGui::PopFont();
-
         ImGui::End();
 
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        renderImGui(gpuPassImGui);
     }
 };
 
-int main()
+const menuDescription startMenu = { "PING PANG THE SECOND", { { "Start Game", menuStartGame }, { "Quit Game", menuQuit } }, 2 };
+const menuDescription leftWinsMenu = { "Left Player Wins!", { { "Play Again", menuPlayAgain }, { "Quit Game", menuQuit } }, 2 };
+const menuDescription rightWinsMenu = { "Right Player Wins!", { { "Play Again", menuPlayAgain }, { "Quit Game", menuQuit } }, 2 };
+
+void renderMenu(myCoolOpenGLApp &App, menuScreen &menu, ImFont* &bigFont, ImFont* &mediumFont, simulationCommands &commands) {
+    PROFILE_ZONE("renderMenu");
+    ALLOCATION_SCOPE(allocationUI);
+    ImGui_ImplOpenGL3_NewFrame();
+    ImGui_ImplGlfw_NewFrame();
+    ImGui::NewFrame();
+
+    menuAction action = menu.draw(static_cast<float>(App.windowWidth), static_cast<float>(App.windowHeight), bigFont, mediumFont);
+    if (action == menuStartGame)
+        commands.post(commandStartGame);
+    if (action == menuPlayAgain)
+        commands.post(commandPlayAgain);
+    if (action == menuQuit)
+        glfwSetWindowShouldClose(App.window, GL_TRUE);
+
+    renderImGui(gpuPassMenu);
+}
+
+int main(int argc, char** argv)
 {
+    startupGraph startup; // first, its report counts from here
+    settings.parseArgs(argc, argv);
+
+    if (!settings.tracePath.empty()) {
+#ifdef PONG_PROFILE
+        profiler::start();
+#else
+        std::cout << "--trace needs a build with PONG_PROFILE defined" << std::endl;
+#endif
+    }
+    allocationStats.init(settings.allocationStats, settings.allocationStatsPath, settings.allocationSampleEvery);
+
     myCoolOpenGLApp App;
-    if (App.init() != 0)
-        return -1;
-    glfwSetWindowUserPointer(App.window, &App);
+    App.addStartupTasks(startup);
 
-    basicGraphicalThings BGT;
-    verticesAndIndicesForShapes VAIFS;
-    Camera camera(App.window, App.windowWidth, App.windowHeight);
     mainScreen MAINSCREEN;
-    startScreen STARTSCREEN;
-    leftPlayerWins LEFTSCREEN;
-    rightPlayerWins RIGHTSCREEN;
+    menuScreen STARTSCREEN(startMenu);
+    menuScreen LEFTSCREEN(leftWinsMenu);
+    menuScreen RIGHTSCREEN(rightWinsMenu);
 
     // the screens are Main, Left Wins, Right Wins, and Start.
-    int screenOn = 3;
-
-    renderCube backgroundCube;
-    backgroundCube.setup(0.0f, 1.0f, 0.0f, 1.0f, glm::vec3(0.0f, -0.75f, 1.25f), glm::vec3(3.0f, 0.1f, 2.0f));
-
-    renderCube TopCube;
-    TopCube.setup(0.0f, 0.0f, 0.0f, 1.0f, glm::vec3(0.0f, -0.75f, 2.25f), glm::vec3(3.0f, 0.3f, 0.3f));
-
-    renderCube BottomCube;
-    BottomCube.setup(0.0f, 0.0f, 0.0f, 1.0f, glm::vec3(0.0f, -0.75f, 0.25f), glm::vec3(3.0f, 0.3f, 0.3f));
-
-    renderCube RightCube;
-    RightCube.setup(0.0f, 0.0f, 0.0f, 1.0f, glm::vec3(1.5f, -0.75f, 1.25f), glm::vec3(0.3f, 0.3f, 2.3f));
-
-    renderCube LeftCube;
-    LeftCube.setup(0.0f, 0.0f, 0.0f, 1.0f, glm::vec3(-1.5f, -0.75f, 1.25f), glm::vec3(0.3f, 0.3f, 2.3f));
-
-    renderCube BouncingCube;
-    BouncingCube.setup(0.0f, 0.0f, 1.0f, 1.0f, glm::vec3(0.0f, -0.575f, 1.25f), glm::vec3(0.25f, 0.25f, 0.25f));
-
-    renderCube RightPlayer;
-    RightPlayer.setup(1.0f, 0.0f, 0.0f, 1.0f, glm::vec3(-1.0, -0.75, 1.25), glm::vec3(0.10f, 0.25f, 0.40f));
-
-    renderCube LeftPlayer;
-    LeftPlayer.setup(1.0f, 0.0f, 0.0f, 1.0f, glm::vec3(1.0, -0.75, 1.25), glm::vec3(0.10f, 0.25f, 0.40f));
+    int screenOn = settings.skipMenu ? 0 : 3;
+
+    // what the simulation moves. The render side only sees it through snapshots, as instances of the models below.
+    ecsWorld world;
+    arenaEntities arenaBodies = spawnArena(world);
+    spawnSandboxBalls(world, settings.sandboxBalls);
+    // the render thread and the simulation thread are busy already, workers get the other cores
+    int spareCores = static_cast<int>(std::thread::hardware_concurrency()) - 2;
+    jobs.start(settings.jobThreads >= 0 ? settings.jobThreads : (spareCores > 0 ? spareCores : 0));
+
+    // one per renderable model, in the order they're drawn
+    renderModel models[modelCount];
+    models[modelFloor].setup(0.0f, 1.0f, 0.0f, 1.0f);
+    models[modelWall].setup(0.0f, 0.0f, 0.0f, 1.0f);
+    models[modelBall].setup(0.0f, 0.0f, 1.0f, 1.0f);
+    models[modelPaddle].setup(1.0f, 0.0f, 0.0f, 1.0f);
+
+    // OBJ meshes replace the cubes when they're there, see meshImport. Skins decode from the start and stream onto
+    // the GPU a slice a frame, see textureStreamer.
+    const char* const modelNames[modelCount] = { "floor", "wall", "ball", "paddle" };
+    for (int model = 0; model < modelCount; model++) {
+        models[model].setMesh(settings.meshDirectory + "/" + modelNames[model] + ".obj");
+        models[model].setSkin(settings.textureDirectory + "/" + modelNames[model] + ".png");
+    }
+    textures.start(2);
 
-    float speedX;
-    float speedZ;
+    simulationCommands simCommands;
     int leftPlayerScore = 0;
     int rightPlayerScore = 0;
 
     bool Timed = true;
 
-    ImGuiIO& io = ImGui::GetIO();
-    ImFont* smallFont = io.Fonts->AddFontFromFileTTF("fonts\\VCR_OSD_MONO_1.001.ttf", 12.0f); // 32 px
-    ImFont* bigFont = io.Fonts->AddFontFromFileTTF("fonts\\VCR_OSD_MONO_1.001.ttf", 120.0f); // 32 px
-    ImFont* mediumFont = io.Fonts->AddFontFromFileTTF("fonts\\VCR_OSD_MONO_1.001.ttf", 60.0f); // 32 px
+    ImFont* smallFont = nullptr;
+    ImFont* bigFont = nullptr;
+    ImFont* mediumFont = nullptr;
+
+    // CPU work for the fonts and the arena overlaps the window being created, the start screen only waits for the
+    // ImGui fonts. The arena and the score HUD go onto the GPU behind the start screen.
+    int cubeSources = startup.add("arena shader sources", startupWorker, [&models] {
+        for (renderModel& model : models)
+            model.prepare();
+        return true;
+    });
+    int hudFont = startup.add("score font", startupWorker, [] {
+        hud.loadFont(fonts.ttf); // plays on without scores if the font is missing
+        return true;
+    }, { App.fontTask });
+    int atlas = startup.add("ImGui font atlas", startupWorker, [&smallFont, &bigFont, &mediumFont] {
+        ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+        smallFont = fonts.addSize(atlas, 12.0f);
+        bigFont = fonts.addSize(atlas, 120.0f);
+        mediumFont = fonts.addSize(atlas, 60.0f);
+        return fonts.bake(atlas, settings.fontCachePath); // every glyph baked before the first frame
+    }, { App.imguiContextTask, App.fontTask });
+    startup.add("ImGui backends", startupMain, [&App] { return App.initImGui(); }, { atlas });
+    startup.add("font texture", startupMain, [] { return fontCache::upload(); });
+    startup.add("texture placeholder", startupMain, [] {
+        textures.initGL();
+        return true;
+    });
+    startup.add("score HUD", startupDeferred, [] {
+        hud.init();
+        return true;
+    }, { hudFont });
+    startup.add("arena", startupDeferred, [&models] {
+        for (renderModel& model : models)
+            if (model.upload() != 0)
+                return false;
+        return true;
+    }, { cubeSources });
+
+    if (!startup.run())
+        return -1;
+    // straight into a game, it needs everything now
+    if (settings.skipMenu && !startup.runDeferred())
+        return -1;
+    glfwSetWindowUserPointer(App.window, &App);
+    bool startupReported = false;
+    bool menuShown = false;
 
+    Camera camera(App.window, App.windowWidth, App.windowHeight);
     camera.setPosition(glm::vec3(0.0f, 3.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
 
     App.mainLoop(
-        [&App, &LeftPlayer, &RightPlayer, &MAINSCREEN, &screenOn, &smallFont] {
+        [&world, &arenaBodies, &leftPlayerScore, &rightPlayerScore, &MAINSCREEN, &screenOn, &simCommands] {
+            unsigned commands = simCommands.take();
+            if (commands & commandStartGame)
+                screenOn = 0;
+            if (commands & commandPlayAgain) {
+                screenOn = 0;
+                leftPlayerScore = 0;
+                rightPlayerScore = 0;
+                resetBall(*world.get<transform>(arenaBodies.ball), *world.get<velocity>(arenaBodies.ball));
+            }
+            if (commands & commandToggleWireframe)
+                MAINSCREEN.wireframeOn = !MAINSCREEN.wireframeOn;
+
             if (screenOn == 0)
-                MAINSCREEN.Input(App, LeftPlayer, RightPlayer, smallFont);
+                MAINSCREEN.Input(world);
         },
-        [&BGT, &App, &camera, &backgroundCube, &TopCube, &BottomCube, &RightCube, &LeftCube,
-        &BouncingCube, &LeftPlayer, &RightPlayer, &speedX, &speedZ, &bigFont, &smallFont,
-        &leftPlayerScore, &rightPlayerScore, &MAINSCREEN, &STARTSCREEN, &LEFTSCREEN, &RIGHTSCREEN,
-        &screenOn, &mediumFont, &Timed] {
-
-            if (screenOn == 3)
-                STARTSCREEN.Render(App, bigFont, mediumFont, screenOn);
-            if (screenOn == 1)
-                LEFTSCREEN.Render(App, bigFont, mediumFont, screenOn, leftPlayerScore, rightPlayerScore, speedX, speedZ, BouncingCube);
-            if (screenOn == 2)
-                RIGHTSCREEN.Render(App, bigFont, mediumFont, screenOn, leftPlayerScore, rightPlayerScore, speedX, speedZ, BouncingCube);
+        [&App, &world, &arenaBodies, &leftPlayerScore, &rightPlayerScore, &MAINSCREEN, &screenOn, &Timed] {
             if (screenOn == 0)
-                MAINSCREEN.Render(BGT, App, camera,
-                    backgroundCube, TopCube, BottomCube,
-                    RightCube, LeftCube, BouncingCube,
-                    LeftPlayer, RightPlayer, speedX, speedZ,
-                    bigFont, smallFont, leftPlayerScore, rightPlayerScore, screenOn, Timed);
+                MAINSCREEN.Simulate(App, world, arenaBodies, leftPlayerScore, rightPlayerScore, screenOn, Timed);
+        },
+        [&world, &leftPlayerScore, &rightPlayerScore, &MAINSCREEN, &screenOn, &Timed](gameSnapshot& state) {
+            renderExtractionSystem(world, jobs, MAINSCREEN.scratch, state.instances);
+            state.leftPlayerScore = leftPlayerScore;
+            state.rightPlayerScore = rightPlayerScore;
+            state.screenOn = screenOn;
+            state.timed = Timed;
+            state.timerValue = MAINSCREEN.TimerValue;
+            state.wireframeOn = MAINSCREEN.wireframeOn;
+        },
+        [&App, &camera, &models, &bigFont, &smallFont,
+        &MAINSCREEN, &STARTSCREEN, &LEFTSCREEN, &RIGHTSCREEN,
+        &mediumFont, &simCommands, &startup, &startupReported, &menuShown](const gameSnapshot& state, float alpha) {
+            textures.update(settings.textureUploadMilliseconds);
+
+            // the rest of startup, a task a frame once the menu is on screen, or all of it when a game starts
+            if (!startup.finished) {
+                bool started = state.screenOn == 0 ? startup.runDeferred() : !menuShown || startup.runNextDeferred();
+                if (!started) {
+                    glfwSetWindowShouldClose(App.window, GLFW_TRUE);
+                    return;
+                }
+            }
+            if (!startupReported && startup.finished && App.firstFrameSwapped != 0) {
+                startup.report(App.firstFrameSwapped, settings.startupReportPath);
+                startupReported = true;
+            }
+            App.loading = !startup.finished || textures.pending != 0;
+            App.staticScreen = state.screenOn != 0 && !App.loading;
+
+            if (state.screenOn == 3)
+                renderMenu(App, STARTSCREEN, bigFont, mediumFont, simCommands);
+            if (state.screenOn == 1)
+                renderMenu(App, LEFTSCREEN, bigFont, mediumFont, simCommands);
+            if (state.screenOn == 2)
+                renderMenu(App, RIGHTSCREEN, bigFont, mediumFont, simCommands);
+            menuShown = menuShown || state.screenOn != 0;
+            if (state.screenOn == 0)
+                MAINSCREEN.Render(App, camera, models, smallFont, state, simCommands, alpha);
         }
     );
 
     // App Clean Up
+    startup.join(); // the workers may still be busy if the game was closed straight away
+    if (!startupReported)
+        startup.report(App.firstFrameSwapped, settings.startupReportPath);
+#ifdef PONG_PROFILE
+    if (!settings.tracePath.empty() && !profiler::dump(settings.tracePath.c_str()))
+        std::cout << "Couldn't write trace to " << settings.tracePath << std::endl;
+#endif
+    latency.shutdown();
+    telemetry.shutdown();
+    gpuTimers.shutdown();
+    dynamicRes.shutdown();
+    hud.shutdown();
+    textures.shutdown();
+    jobs.stop();
+    video.shutdown();
+    headless.shutdown();
+    bool withinCallBudget = nullBackend.shutdown(settings.nullGLLogPath, settings.glCallBudget);
+    bool allocationFree = allocations.shutdown();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
-    ma_engine_uninit(&engine);
-    BGT.cleanUp();
+    synthSounds.uninit();
+    packedSounds.uninit();
+    if (audioStarted)
+        ma_engine_uninit(&engine);
+    for (renderModel& model : models)
+        model.cleanUp();
     glfwTerminate();
+    assets.close();
+    allocationStats.shutdown();
+    return withinCallBudget && allocationFree ? 0 : 1;
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A whole file mapped read-only into memory. data stays valid until close(), and pages are only read in when
+// something touches them.
+class mappedFile {
+public:
+    const unsigned char* data = nullptr;
+    uint64_t size = 0;
+
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#else
+    int file = -1;
+#endif
+
+    mappedFile() = default;
+    mappedFile(const mappedFile&) = delete;
+    mappedFile& operator=(const mappedFile&) = delete;
+
+    ~mappedFile() {
+        close();
+    }
+
+    bool isOpen() const {
+        return data != nullptr;
+    }
+
+    // false for a missing or empty file
+    bool open(const char* path) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            close();
+            return false;
+        }
+        size = static_cast<uint64_t>(fileSize.QuadPart);
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        data = mapping != NULL ? static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+#else
+        file = ::open(path, O_RDONLY);
+        if (file == -1)
+            return false;
+        struct stat info;
+        if (fstat(file, &info) != 0 || info.st_size == 0) {
+            close();
+            return false;
+        }
+        size = static_cast<uint64_t>(info.st_size);
+        void* mapped = mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_PRIVATE, file, 0);
+        data = mapped != MAP_FAILED ? static_cast<const unsigned char*>(mapped) : nullptr;
+#endif
+        if (data == nullptr) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (data != nullptr)
+            UnmapViewOfFile(data);
+        if (mapping != NULL)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (data != nullptr)
+            munmap(const_cast<unsigned char*>(data), static_cast<size_t>(size));
+        if (file != -1)
+            ::close(file);
+        file = -1;
+#endif
+        data = nullptr;
+        size = 0;
+    }
+};
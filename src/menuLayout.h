@@ -0,0 +1,135 @@
+#pragma once
+#include <cstring>
+#include <vector>
+#include "imgui.h"
+
+enum menuAction { menuNone, menuStartGame, menuPlayAgain, menuQuit };
+
+struct menuButton {
+    const char* label;
+    menuAction action;
+};
+
+// A menu screen as data: a title over a column of buttons
+struct menuDescription {
+    static const int maxButtons = 4;
+    const char* title;
+    menuButton buttons[maxButtons];
+    int buttonCount;
+};
+
+// Lays a menuDescription out once per window size and font, and records the title, labels and button outlines as
+// draw list vertices. A frame is then a hit test, a filled rect per button for its hover state and a copy of the
+// recorded vertices into ImGui's background draw list, with no windows and no text measuring. Looks the same as the
+// per-screen ImGui windows it replaced: title 100 px down, 500x100 buttons from the middle of the screen, 120 apart.
+class menuScreen {
+public:
+    static constexpr float buttonWidth = 500.0f;
+    static constexpr float buttonHeight = 100.0f;
+    static constexpr float buttonSpacing = 120.0f;
+
+    menuDescription description;
+
+    // what the layout was made for
+    float width = 0.0f;
+    float height = 0.0f;
+    const ImFont* titleFont = nullptr;
+    const ImFont* buttonFont = nullptr;
+    ImTextureID texture = (ImTextureID)NULL;
+
+    ImVec2 buttonMin[menuDescription::maxButtons];
+    ImVec2 buttonMax[menuDescription::maxButtons];
+    std::vector<ImDrawVert> vertices; // title, labels and outlines, indices relative to the first vertex
+    std::vector<ImDrawIdx> indices;
+    int pressed = -1;                 // button the mouse went down on, clicks land on release like ImGui::Button
+
+    explicit menuScreen(const menuDescription& description) : description(description) {}
+
+    bool layoutValid(float windowWidth, float windowHeight, const ImFont* title, const ImFont* buttons) const {
+        return width == windowWidth && height == windowHeight && titleFont == title && buttonFont == buttons
+            && texture == ImGui::GetIO().Fonts->TexID;
+    }
+
+    // call inside an ImGui frame, the draw list needs the frame's white pixel and font texture
+    void layout(float windowWidth, float windowHeight, ImFont* title, ImFont* buttons) {
+        width = windowWidth;
+        height = windowHeight;
+        titleFont = title;
+        buttonFont = buttons;
+        texture = ImGui::GetIO().Fonts->TexID;
+
+        const ImGuiStyle& style = ImGui::GetStyle();
+        const ImU32 white = IM_COL32(255, 255, 255, 255);
+        ImDrawList recording(ImGui::GetDrawListSharedData());
+        recording._ResetForNewFrame();
+        recording.PushClipRect(ImVec2(0.0f, 0.0f), ImVec2(width, height));
+        recording.PushTextureID(texture);
+
+        if (style.WindowBorderSize > 0.0f)
+            recording.AddRect(ImVec2(0.0f, 0.0f), ImVec2(width, height), ImGui::GetColorU32(ImGuiCol_Border), 0.0f, 0, style.WindowBorderSize);
+
+        ImVec2 titleSize = title->CalcTextSizeA(title->FontSize, FLT_MAX, 0.0f, description.title);
+        recording.AddText(title, title->FontSize, ImVec2((width - titleSize.x) * 0.5f, 100.0f + style.WindowPadding.y), white, description.title);
+
+        // truncated like the old code, which positioned windows at an integer half height
+        float top = static_cast<float>(static_cast<int>(height) / 2) + style.WindowPadding.y;
+        for (int i = 0; i < description.buttonCount; i++) {
+            buttonMin[i] = ImVec2((width - buttonWidth) * 0.5f, top + buttonSpacing * i);
+            buttonMax[i] = ImVec2(buttonMin[i].x + buttonWidth, buttonMin[i].y + buttonHeight);
+            const char* label = description.buttons[i].label;
+            ImVec2 labelSize = buttons->CalcTextSizeA(buttons->FontSize, FLT_MAX, 0.0f, label);
+            recording.AddText(buttons, buttons->FontSize, ImVec2(buttonMin[i].x + (buttonWidth - labelSize.x) * 0.5f,
+                buttonMin[i].y + (buttonHeight - labelSize.y) * 0.5f), white, label);
+            recording.AddRect(buttonMin[i], buttonMax[i], IM_COL32(0, 255, 0, 255), 0.0f, 0, 5.0f);
+        }
+
+        vertices.assign(recording.VtxBuffer.begin(), recording.VtxBuffer.end());
+        indices.assign(recording.IdxBuffer.begin(), recording.IdxBuffer.end());
+    }
+
+    // call inside an ImGui frame. Returns the action of a button clicked this frame.
+    menuAction draw(float windowWidth, float windowHeight, ImFont* title, ImFont* buttons) {
+        if (!layoutValid(windowWidth, windowHeight, title, buttons))
+            layout(windowWidth, windowHeight, title, buttons);
+
+        const ImGuiIO& io = ImGui::GetIO();
+        const ImGuiStyle& style = ImGui::GetStyle();
+        ImDrawList* drawList = ImGui::GetBackgroundDrawList();
+
+        // a debug window over the menu keeps the mouse to itself
+        int hovered = -1;
+        if (!io.WantCaptureMouse)
+            for (int i = 0; i < description.buttonCount; i++)
+                if (io.MousePos.x >= buttonMin[i].x && io.MousePos.y >= buttonMin[i].y && io.MousePos.x < buttonMax[i].x && io.MousePos.y < buttonMax[i].y)
+                    hovered = i;
+
+        menuAction clicked = menuNone;
+        if (io.MouseClicked[0])
+            pressed = hovered;
+        if (io.MouseReleased[0]) {
+            if (pressed != -1 && pressed == hovered)
+                clicked = description.buttons[pressed].action;
+            pressed = -1;
+        }
+
+        drawList->AddRectFilled(ImVec2(0.0f, 0.0f), ImVec2(width, height), ImGui::GetColorU32(ImGuiCol_WindowBg));
+        for (int i = 0; i < description.buttonCount; i++) {
+            ImGuiCol color = i == hovered ? (i == pressed ? ImGuiCol_ButtonActive : ImGuiCol_ButtonHovered) : ImGuiCol_Button;
+            drawList->AddRectFilled(buttonMin[i], buttonMax[i], ImGui::GetColorU32(color), style.FrameRounding);
+        }
+
+        // the background list has no texture pushed of its own, so the font texture is already current
+        int vertexCount = static_cast<int>(vertices.size());
+        int indexCount = static_cast<int>(indices.size());
+        ImDrawIdx first = static_cast<ImDrawIdx>(drawList->_VtxCurrentIdx);
+        drawList->PrimReserve(indexCount, vertexCount);
+        memcpy(drawList->_VtxWritePtr, vertices.data(), sizeof(ImDrawVert) * vertexCount);
+        for (int i = 0; i < indexCount; i++)
+            drawList->_IdxWritePtr[i] = static_cast<ImDrawIdx>(first + indices[i]);
+        drawList->_VtxWritePtr += vertexCount;
+        drawList->_IdxWritePtr += indexCount;
+        drawList->_VtxCurrentIdx += vertexCount;
+
+        return clicked;
+    }
+};
@@ -0,0 +1,126 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+#include "mappedFile.h"
+
+// An imported mesh on disk, ready to hand to glBufferData as it is:
+//
+//     header | vertices (vertexCount * vertexStride bytes) | indices (indexCount * indexSize bytes)
+//
+// Vertices are just positions for now, three floats, which is all the cube shader reads. Indices are 16 bit
+// whenever the vertex count allows it. Written by meshImport, little endian like everything else.
+struct meshCacheHeader {
+    static const uint32_t fileMagic = 0x48534D50; // "PMSH"
+    static const uint32_t fileVersion = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t indexSize;    // 2 or 4 bytes
+    uint32_t vertexStride; // bytes
+    uint64_t sourceSize;   // the .obj it came from, so a changed file gets imported again
+    int64_t sourceTime;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+static_assert(sizeof(meshCacheHeader) == 64, "the vertices start 64 bytes in");
+
+// size and modification time of a file, false when it isn't there
+inline bool fileStamp(const char* path, uint64_t& size, int64_t& time) {
+#ifdef _WIN32
+    struct _stat64 info;
+    if (_stat64(path, &info) != 0)
+        return false;
+#else
+    struct stat info;
+    if (stat(path, &info) != 0)
+        return false;
+#endif
+    size = static_cast<uint64_t>(info.st_size);
+    time = static_cast<int64_t>(info.st_mtime);
+    return true;
+}
+
+// A mesh cache file mapped into memory, its vertices and indices read straight out of the mapping
+class cachedMesh {
+public:
+    mappedFile file;
+    const meshCacheHeader* header = nullptr;
+    const unsigned char* vertices = nullptr;
+    const unsigned char* indices = nullptr;
+
+    bool isOpen() const {
+        return header != nullptr;
+    }
+
+    bool open(const char* path) {
+        close();
+        if (!file.open(path))
+            return false;
+
+        const meshCacheHeader* candidate = reinterpret_cast<const meshCacheHeader*>(file.data);
+        bool valid = file.size >= sizeof(meshCacheHeader) && candidate->magic == meshCacheHeader::fileMagic
+            && candidate->version == meshCacheHeader::fileVersion && (candidate->indexSize == 2 || candidate->indexSize == 4)
+            && candidate->vertexStride > 0 && candidate->indexCount % 3 == 0
+            && file.size == sizeof(meshCacheHeader) + vertexBytes(*candidate) + indexBytes(*candidate);
+        if (!valid) {
+            close();
+            return false;
+        }
+
+        header = candidate;
+        vertices = file.data + sizeof(meshCacheHeader);
+        indices = vertices + vertexBytes(*header);
+        if (!indicesInRange()) {
+            // glDrawElements would read past the vertex buffer, import it again instead
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        file.close();
+        header = nullptr;
+        vertices = nullptr;
+        indices = nullptr;
+    }
+
+    // whether it was imported from this exact .obj. A cache without its source is taken as it is.
+    bool matchesSource(const char* objPath) const {
+        uint64_t size = 0;
+        int64_t time = 0;
+        if (!fileStamp(objPath, size, time))
+            return true;
+        return header->sourceSize == size && header->sourceTime == time;
+    }
+
+    // every index names one of the vertices. Read with memcpy, the indices needn't be aligned in the file.
+    bool indicesInRange() const {
+        for (uint32_t i = 0; i < header->indexCount; i++) {
+            uint32_t index = 0;
+            if (header->indexSize == 2) {
+                uint16_t shortIndex;
+                memcpy(&shortIndex, indices + static_cast<uint64_t>(i) * 2, 2);
+                index = shortIndex;
+            }
+            else
+                memcpy(&index, indices + static_cast<uint64_t>(i) * 4, 4);
+            if (index >= header->vertexCount)
+                return false;
+        }
+        return true;
+    }
+
+    static uint64_t vertexBytes(const meshCacheHeader& header) {
+        return static_cast<uint64_t>(header.vertexCount) * header.vertexStride;
+    }
+
+    static uint64_t indexBytes(const meshCacheHeader& header) {
+        return static_cast<uint64_t>(header.indexCount) * header.indexSize;
+    }
+};
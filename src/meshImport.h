@@ -0,0 +1,307 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "objLoader/tiny_obj_loader.h"
+#include "meshCache.h"
+
+struct importedMesh {
+    std::vector<float> positions; // xyz per vertex
+    std::vector<uint32_t> indices;
+    float boundsMin[3] = { 0.0f, 0.0f, 0.0f };
+    float boundsMax[3] = { 0.0f, 0.0f, 0.0f };
+
+    uint32_t vertexCount() const {
+        return static_cast<uint32_t>(positions.size() / 3);
+    }
+};
+
+// .obj to mesh cache. The text is parsed with tinyobjloader, identical positions are merged, triangles are reordered
+// so the GPU's post-transform cache gets reused (Forsyth's linear-speed optimizer) and vertices are renumbered in the
+// order the triangles first use them. Only runs when the cache is missing or older than its .obj.
+//
+//     cachedMesh mesh;
+//     meshImport::load("meshes/ball.obj", mesh);   // maps meshes/ball.mesh, importing it first if it has to
+//
+// Meshes are drawn where the cubes were and scaled the same way, so author them to fit the unit cube around the origin.
+class meshImport {
+public:
+    static const int cacheSize = 32; // the cache the optimizer models; a little bigger than real hardware is fine
+
+    static std::string cachePathFor(const std::string& objPath) {
+        size_t dot = objPath.find_last_of('.');
+        size_t slash = objPath.find_last_of("/\\");
+        bool hasExtension = dot != std::string::npos && (slash == std::string::npos || dot > slash);
+        return (hasExtension ? objPath.substr(0, dot) : objPath) + ".mesh";
+    }
+
+    // the mapped cache for objPath, imported again when the .obj changed. False when there's neither.
+    static bool load(const std::string& objPath, cachedMesh& mesh) {
+        std::string cachePath = cachePathFor(objPath);
+        if (mesh.open(cachePath.c_str()) && mesh.matchesSource(objPath.c_str()))
+            return true;
+        mesh.close();
+
+        uint64_t sourceSize = 0;
+        int64_t sourceTime = 0;
+        if (!fileStamp(objPath.c_str(), sourceSize, sourceTime))
+            return false;
+        importedMesh imported;
+        if (!importObj(objPath.c_str(), imported))
+            return false;
+        if (!writeCache(cachePath.c_str(), imported, sourceSize, sourceTime)) {
+            std::cout << "Couldn't write mesh cache " << cachePath << std::endl;
+            return false;
+        }
+        return mesh.open(cachePath.c_str());
+    }
+
+    static bool importObj(const char* path, importedMesh& mesh) {
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string warning, error;
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warning, &error, path, nullptr, true)) {
+            std::cout << "Couldn't import " << path << ": " << error << std::endl;
+            return false;
+        }
+
+        std::unordered_map<positionKey, uint32_t, positionHash> merged;
+        mesh.positions.clear();
+        mesh.indices.clear();
+        for (const tinyobj::shape_t& shape : shapes) {
+            for (const tinyobj::index_t& corner : shape.mesh.indices) {
+                if (corner.vertex_index < 0 || static_cast<size_t>(corner.vertex_index) * 3 + 2 >= attrib.vertices.size()) {
+                    std::cout << "Couldn't import " << path << ": a face uses a vertex that isn't there" << std::endl;
+                    return false;
+                }
+                const tinyobj::real_t* position = &attrib.vertices[static_cast<size_t>(corner.vertex_index) * 3];
+                positionKey key;
+                for (int axis = 0; axis < 3; axis++) {
+                    float value = static_cast<float>(position[axis]) + 0.0f; // -0 and 0 are the same vertex
+                    memcpy(&key.bits[axis], &value, sizeof(float));
+                }
+                auto found = merged.find(key);
+                if (found == merged.end()) {
+                    found = merged.emplace(key, mesh.vertexCount()).first;
+                    for (int axis = 0; axis < 3; axis++)
+                        mesh.positions.push_back(static_cast<float>(position[axis]) + 0.0f);
+                }
+                mesh.indices.push_back(found->second);
+            }
+        }
+        if (mesh.indices.empty()) {
+            std::cout << "Couldn't import " << path << ": no triangles" << std::endl;
+            return false;
+        }
+
+        double before = averageCacheMissRatio(mesh.indices, 16);
+        optimizeVertexCache(mesh.indices, mesh.vertexCount());
+        reorderVertices(mesh);
+        computeBounds(mesh);
+        std::cout << "Imported " << path << ": " << mesh.vertexCount() << " vertices, " << mesh.indices.size() / 3
+            << " triangles, ACMR " << before << " -> " << averageCacheMissRatio(mesh.indices, 16) << std::endl;
+        return true;
+    }
+
+    static float vertexScore(int cachePosition, uint32_t liveTriangles) {
+        if (liveTriangles == 0)
+            return -1.0f;
+        float score = 0.0f;
+        if (cachePosition >= 0) {
+            // the triangle just drawn: deliberately worth less, so strips don't run away from the rest of the cache
+            if (cachePosition < 3)
+                score = 0.75f;
+            else
+                score = std::pow(1.0f - (cachePosition - 3) * (1.0f / (cacheSize - 3)), 1.5f);
+        }
+        // vertices with few triangles left are finished off first
+        return score + 2.0f * std::pow(static_cast<float>(liveTriangles), -0.5f);
+    }
+
+    // Tom Forsyth's "Linear-Speed Vertex Cache Optimisation": greedily draw the triangle whose vertices score best
+    // in an LRU model of the cache.
+    static void optimizeVertexCache(std::vector<uint32_t>& indices, uint32_t vertexCount) {
+        size_t triangleCount = indices.size() / 3;
+        if (triangleCount == 0)
+            return;
+
+        // the triangles around each vertex, the first liveTriangles[v] of them not drawn yet
+        std::vector<uint32_t> firstTriangle(vertexCount + 1, 0);
+        for (uint32_t index : indices)
+            firstTriangle[index + 1]++;
+        for (uint32_t v = 0; v < vertexCount; v++)
+            firstTriangle[v + 1] += firstTriangle[v];
+        std::vector<uint32_t> triangles(indices.size());
+        std::vector<uint32_t> liveTriangles(vertexCount, 0);
+        for (size_t t = 0; t < triangleCount; t++)
+            for (int corner = 0; corner < 3; corner++) {
+                uint32_t v = indices[t * 3 + corner];
+                triangles[firstTriangle[v] + liveTriangles[v]++] = static_cast<uint32_t>(t);
+            }
+
+        std::vector<int> cachePosition(vertexCount, -1);
+        std::vector<float> scores(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; v++)
+            scores[v] = vertexScore(-1, liveTriangles[v]);
+        std::vector<bool> drawn(triangleCount, false);
+
+        std::vector<uint32_t> cache;
+        cache.reserve(cacheSize + 3);
+        std::vector<uint32_t> output;
+        output.reserve(indices.size());
+        size_t nextUndrawn = 0;
+        int64_t best = -1;
+
+        while (output.size() < indices.size()) {
+            // nothing left around the cache, start again from the next triangle in the original order
+            if (best < 0) {
+                while (drawn[nextUndrawn])
+                    nextUndrawn++;
+                best = static_cast<int64_t>(nextUndrawn);
+            }
+            drawn[best] = true;
+            const uint32_t* triangle = &indices[best * 3];
+            for (int corner = 0; corner < 3; corner++) {
+                uint32_t v = triangle[corner];
+                output.push_back(v);
+                uint32_t* live = &triangles[firstTriangle[v]];
+                for (uint32_t i = 0; i < liveTriangles[v]; i++)
+                    if (live[i] == static_cast<uint32_t>(best)) {
+                        live[i] = live[--liveTriangles[v]];
+                        break;
+                    }
+            }
+
+            for (int corner = 2; corner >= 0; corner--) {
+                uint32_t v = triangle[corner];
+                for (size_t i = 0; i < cache.size(); i++)
+                    if (cache[i] == v) {
+                        cache.erase(cache.begin() + i);
+                        break;
+                    }
+                cache.insert(cache.begin(), v);
+            }
+            for (size_t i = 0; i < cache.size(); i++) {
+                bool evicted = i >= static_cast<size_t>(cacheSize);
+                cachePosition[cache[i]] = evicted ? -1 : static_cast<int>(i);
+                scores[cache[i]] = vertexScore(cachePosition[cache[i]], liveTriangles[cache[i]]);
+            }
+
+            best = -1;
+            float bestScore = -1.0f;
+            for (uint32_t v : cache) {
+                const uint32_t* live = &triangles[firstTriangle[v]];
+                for (uint32_t i = 0; i < liveTriangles[v]; i++) {
+                    const uint32_t* candidate = &indices[static_cast<size_t>(live[i]) * 3];
+                    float score = scores[candidate[0]] + scores[candidate[1]] + scores[candidate[2]];
+                    if (score > bestScore) {
+                        bestScore = score;
+                        best = live[i];
+                    }
+                }
+            }
+            if (cache.size() > static_cast<size_t>(cacheSize))
+                cache.resize(cacheSize);
+        }
+        indices.swap(output);
+    }
+
+    // renumbers vertices in the order the triangles first reach them, so vertex fetches walk forward through memory
+    static void reorderVertices(importedMesh& mesh) {
+        const uint32_t unused = UINT32_MAX;
+        std::vector<uint32_t> remap(mesh.vertexCount(), unused);
+        std::vector<float> positions;
+        positions.reserve(mesh.positions.size());
+        for (uint32_t& index : mesh.indices) {
+            if (remap[index] == unused) {
+                remap[index] = static_cast<uint32_t>(positions.size() / 3);
+                positions.insert(positions.end(), &mesh.positions[index * 3], &mesh.positions[index * 3] + 3);
+            }
+            index = remap[index];
+        }
+        mesh.positions.swap(positions); // vertices no triangle uses are dropped here
+    }
+
+    static void computeBounds(importedMesh& mesh) {
+        for (int axis = 0; axis < 3; axis++) {
+            mesh.boundsMin[axis] = mesh.positions[axis];
+            mesh.boundsMax[axis] = mesh.positions[axis];
+        }
+        for (size_t i = 0; i < mesh.positions.size(); i++) {
+            int axis = static_cast<int>(i % 3);
+            if (mesh.positions[i] < mesh.boundsMin[axis])
+                mesh.boundsMin[axis] = mesh.positions[i];
+            if (mesh.positions[i] > mesh.boundsMax[axis])
+                mesh.boundsMax[axis] = mesh.positions[i];
+        }
+    }
+
+    // vertices transformed per triangle with a FIFO cache of the given size: 3 is no reuse at all, 0.5 is about ideal
+    static double averageCacheMissRatio(const std::vector<uint32_t>& indices, int fifoSize) {
+        std::vector<uint32_t> fifo;
+        size_t misses = 0;
+        for (uint32_t index : indices) {
+            bool hit = false;
+            for (uint32_t cached : fifo)
+                hit = hit || cached == index;
+            if (hit)
+                continue;
+            misses++;
+            fifo.push_back(index);
+            if (fifo.size() > static_cast<size_t>(fifoSize))
+                fifo.erase(fifo.begin());
+        }
+        return indices.empty() ? 0.0 : static_cast<double>(misses) / (indices.size() / 3);
+    }
+
+    static bool writeCache(const char* path, const importedMesh& mesh, uint64_t sourceSize, int64_t sourceTime) {
+        meshCacheHeader header = {};
+        header.magic = meshCacheHeader::fileMagic;
+        header.version = meshCacheHeader::fileVersion;
+        header.vertexCount = mesh.vertexCount();
+        header.indexCount = static_cast<uint32_t>(mesh.indices.size());
+        header.indexSize = mesh.vertexCount() <= 0x10000 ? 2 : 4;
+        header.vertexStride = sizeof(float) * 3;
+        header.sourceSize = sourceSize;
+        header.sourceTime = sourceTime;
+        memcpy(header.boundsMin, mesh.boundsMin, sizeof(header.boundsMin));
+        memcpy(header.boundsMax, mesh.boundsMax, sizeof(header.boundsMax));
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(mesh.positions.data()), static_cast<std::streamsize>(sizeof(float) * mesh.positions.size()));
+        if (header.indexSize == 2) {
+            std::vector<uint16_t> shortIndices(mesh.indices.begin(), mesh.indices.end());
+            file.write(reinterpret_cast<const char*>(shortIndices.data()), static_cast<std::streamsize>(sizeof(uint16_t) * shortIndices.size()));
+        }
+        else
+            file.write(reinterpret_cast<const char*>(mesh.indices.data()), static_cast<std::streamsize>(sizeof(uint32_t) * mesh.indices.size()));
+        return static_cast<bool>(file);
+    }
+
+private:
+    struct positionKey {
+        uint32_t bits[3];
+
+        bool operator==(const positionKey& other) const {
+            return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+        }
+    };
+
+    struct positionHash {
+        size_t operator()(const positionKey& key) const {
+            uint64_t hash = 0xcbf29ce484222325ull;
+            for (uint32_t bits : key.bits)
+                hash = (hash ^ bits) * 0x100000001b3ull;
+            return static_cast<size_t>(hash);
+        }
+    };
+};
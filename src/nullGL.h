@@ -0,0 +1,354 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <glad/glad.h>
+
+// A GL "driver" that does nothing but count. install() it and pass nullGL::getProcAddress to gladLoadGLLoader
+// instead of glfwGetProcAddress: every GL entry point then lands in a stub that records a 16 bit command id,
+// so the whole frame (scene, ImGui, overlays) runs its CPU side with no GPU or display.
+// Queries that have to answer something say yes: shaders compile, programs link, fences are signalled,
+// glGen* hands out increasing names and glGetIntegerv(GL_VIEWPORT) returns whatever glViewport was given.
+//
+// Only on 64 bit: the shared stubs take no arguments, which is fine when the caller cleans up the stack
+// but not with 32 bit __stdcall.
+class nullGL {
+public:
+    static const int maxCommands = 2048;
+    static const size_t maxLogEntries = 1 << 16;
+
+    bool enabled = false;
+    const char* commandNames[maxCommands] = {};
+    int commandCount = 0;
+    uint64_t callCounts[maxCommands] = {};
+
+    std::vector<uint16_t> frameLog;        // the current frame's calls, in order
+    std::vector<uint16_t> lastGameplayLog; // kept from the last gameplay frame
+    uint64_t frameCalls = 0;
+
+    uint64_t frames = 0;
+    uint64_t gameplayFrames = 0;
+    uint64_t gameplayCalls = 0;
+    uint64_t maxGameplayCalls = 0;
+
+    GLint viewport[4] = {};
+    GLuint nextName = 1;
+    std::vector<unsigned char> mappedScratch;
+
+    static nullGL*& active() {
+        static nullGL* instance = nullptr;
+        return instance;
+    }
+
+    bool install() {
+#if defined(_M_IX86) || defined(__i386__)
+        std::cout << "The null GL backend needs a 64 bit build" << std::endl;
+        return false;
+#else
+        enabled = true;
+        frameLog.reserve(maxLogEntries);
+        active() = this;
+        return true;
+#endif
+    }
+
+    void record(int id) {
+        callCounts[id]++;
+        frameCalls++;
+        if (frameLog.size() < maxLogEntries)
+            frameLog.push_back(static_cast<uint16_t>(id));
+    }
+
+    // after the swap. gameplay is false on the menus, which don't count towards the budget.
+    void endFrame(bool gameplay) {
+        if (!enabled)
+            return;
+        frames++;
+        if (gameplay) {
+            gameplayFrames++;
+            gameplayCalls += frameCalls;
+            if (frameCalls > maxGameplayCalls)
+                maxGameplayCalls = frameCalls;
+            lastGameplayLog.swap(frameLog);
+        }
+        frameLog.clear();
+        frameCalls = 0;
+    }
+
+    // prints the per frame numbers, writes the last gameplay frame's calls to logPath (one per line) if set.
+    // Returns false when a gameplay frame went over callBudget (0 = no budget).
+    bool shutdown(const std::string& logPath, uint64_t callBudget) {
+        if (!enabled)
+            return true;
+
+        std::cout << "Null GL: " << frames << " frames, " << gameplayFrames << " gameplay frames, "
+            << (gameplayFrames > 0 ? gameplayCalls / gameplayFrames : 0) << " GL calls per gameplay frame on average, "
+            << maxGameplayCalls << " at most" << std::endl;
+
+        if (!logPath.empty()) {
+            std::ofstream out(logPath);
+            if (!out)
+                std::cout << "Couldn't write " << logPath << std::endl;
+            for (uint16_t id : lastGameplayLog)
+                out << commandNames[id] << '\n';
+        }
+
+        if (callBudget > 0 && maxGameplayCalls > callBudget) {
+            std::cout << "Gameplay frame issued " << maxGameplayCalls << " GL calls, budget is " << callBudget << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // --- the function table ---
+
+    template <int Id>
+    static void APIENTRY countedStub() {
+        active()->record(Id);
+    }
+
+    template <size_t... Ids>
+    static void* countedStubAt(size_t id, std::index_sequence<Ids...>) {
+        static const std::array<void*, sizeof...(Ids)> table = { { reinterpret_cast<void*>(&countedStub<Ids>)... } };
+        return table[id];
+    }
+
+    // ids of the stubs below, so they can record themselves too
+    enum answeringStub {
+        stubGetString, stubGetStringi, stubGetIntegerv, stubGetFloatv, stubGetBooleanv, stubGetInteger64v,
+        stubViewport, stubGetError, stubCreateShader, stubCreateProgram, stubGenBuffers, stubGenVertexArrays,
+        stubGenTextures, stubGenQueries, stubGenFramebuffers, stubGenRenderbuffers, stubGetShaderiv,
+        stubGetProgramiv, stubGetShaderInfoLog, stubGetProgramInfoLog, stubGetUniformLocation,
+        stubGetAttribLocation, stubGetVertexAttribiv, stubGetVertexAttribPointerv, stubGetQueryObjectiv,
+        stubGetQueryObjectuiv, stubGetQueryObjecti64v, stubGetQueryObjectui64v, stubFenceSync, stubClientWaitSync,
+        stubGetSynciv, stubCheckFramebufferStatus, stubMapBufferRange, stubMapBuffer, stubUnmapBuffer,
+        stubIsEnabled, stubIsProgram, answeringStubCount
+    };
+
+    static int& answeringId(answeringStub stub) {
+        static int ids[answeringStubCount] = {};
+        return ids[stub];
+    }
+
+    static void recordAnswering(answeringStub stub) {
+        active()->record(answeringId(stub));
+    }
+
+    static GLuint newName() {
+        return active()->nextName++;
+    }
+
+    static void genNames(GLsizei n, GLuint* names) {
+        for (GLsizei i = 0; i < n; i++)
+            names[i] = newName();
+    }
+
+    // how many values a glGet* writes, for the ones with more than one
+    static int valueCount(GLenum pname) {
+        switch (pname) {
+        case GL_VIEWPORT: case GL_SCISSOR_BOX: case GL_COLOR_CLEAR_VALUE: case GL_BLEND_COLOR: case GL_COLOR_WRITEMASK:
+            return 4;
+        case GL_POLYGON_MODE: case GL_DEPTH_RANGE: case GL_MAX_VIEWPORT_DIMS:
+            return 2;
+        default:
+            return 1;
+        }
+    }
+
+    template <typename T>
+    static void getValues(GLenum pname, T* values) {
+        int count = valueCount(pname);
+        for (int i = 0; i < count; i++)
+            values[i] = T(0);
+
+        switch (pname) {
+        case GL_VIEWPORT: case GL_SCISSOR_BOX:
+            for (int i = 0; i < 4; i++)
+                values[i] = static_cast<T>(active()->viewport[i]);
+            break;
+        case GL_MAJOR_VERSION: values[0] = T(4); break;
+        case GL_MINOR_VERSION: values[0] = T(6); break;
+        case GL_CONTEXT_PROFILE_MASK: values[0] = static_cast<T>(GL_CONTEXT_CORE_PROFILE_BIT); break;
+        case GL_POLYGON_MODE: values[0] = values[1] = static_cast<T>(GL_FILL); break;
+        case GL_MAX_TEXTURE_SIZE: values[0] = T(16384); break;
+        case GL_NUM_EXTENSIONS: values[0] = T(1); break; // glad treats an empty list as a failed load
+        default: break;
+        }
+    }
+
+    static const GLubyte* APIENTRY getString(GLenum name) {
+        recordAnswering(stubGetString);
+        const char* value = "";
+        switch (name) {
+        case GL_VENDOR: value = "PING PANG"; break;
+        case GL_RENDERER: value = "null recorder"; break;
+        case GL_VERSION: value = "4.6.0 null"; break;
+        case GL_SHADING_LANGUAGE_VERSION: value = "4.60"; break;
+        default: break;
+        }
+        return reinterpret_cast<const GLubyte*>(value);
+    }
+
+    static const GLubyte* APIENTRY getStringi(GLenum, GLuint) { recordAnswering(stubGetStringi); return reinterpret_cast<const GLubyte*>("GL_PONG_null_recorder"); }
+    static void APIENTRY getIntegerv(GLenum pname, GLint* values) { recordAnswering(stubGetIntegerv); getValues(pname, values); }
+    static void APIENTRY getFloatv(GLenum pname, GLfloat* values) { recordAnswering(stubGetFloatv); getValues(pname, values); }
+    static void APIENTRY getBooleanv(GLenum pname, GLboolean* values) { recordAnswering(stubGetBooleanv); getValues(pname, values); }
+    static void APIENTRY getInteger64v(GLenum pname, GLint64* values) { recordAnswering(stubGetInteger64v); getValues(pname, values); }
+
+    static void APIENTRY viewportStub(GLint x, GLint y, GLsizei width, GLsizei height) {
+        recordAnswering(stubViewport);
+        GLint* viewport = active()->viewport;
+        viewport[0] = x; viewport[1] = y; viewport[2] = width; viewport[3] = height;
+    }
+
+    static GLenum APIENTRY getError() { recordAnswering(stubGetError); return GL_NO_ERROR; }
+    static GLuint APIENTRY createShader(GLenum) { recordAnswering(stubCreateShader); return newName(); }
+    static GLuint APIENTRY createProgram() { recordAnswering(stubCreateProgram); return newName(); }
+    static void APIENTRY genBuffers(GLsizei n, GLuint* names) { recordAnswering(stubGenBuffers); genNames(n, names); }
+    static void APIENTRY genVertexArrays(GLsizei n, GLuint* names) { recordAnswering(stubGenVertexArrays); genNames(n, names); }
+    static void APIENTRY genTextures(GLsizei n, GLuint* names) { recordAnswering(stubGenTextures); genNames(n, names); }
+    static void APIENTRY genQueries(GLsizei n, GLuint* names) { recordAnswering(stubGenQueries); genNames(n, names); }
+    static void APIENTRY genFramebuffers(GLsizei n, GLuint* names) { recordAnswering(stubGenFramebuffers); genNames(n, names); }
+    static void APIENTRY genRenderbuffers(GLsizei n, GLuint* names) { recordAnswering(stubGenRenderbuffers); genNames(n, names); }
+
+    static void APIENTRY getShaderiv(GLuint, GLenum pname, GLint* value) {
+        recordAnswering(stubGetShaderiv);
+        *value = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+    }
+
+    static void APIENTRY getProgramiv(GLuint, GLenum pname, GLint* value) {
+        recordAnswering(stubGetProgramiv);
+        *value = (pname == GL_LINK_STATUS || pname == GL_VALIDATE_STATUS) ? GL_TRUE : 0;
+    }
+
+    static void emptyLog(GLsizei bufSize, GLsizei* length, GLchar* infoLog) {
+        if (length != nullptr)
+            *length = 0;
+        if (infoLog != nullptr && bufSize > 0)
+            infoLog[0] = '\0';
+    }
+
+    static void APIENTRY getShaderInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog) { recordAnswering(stubGetShaderInfoLog); emptyLog(bufSize, length, infoLog); }
+    static void APIENTRY getProgramInfoLog(GLuint, GLsizei bufSize, GLsizei* length, GLchar* infoLog) { recordAnswering(stubGetProgramInfoLog); emptyLog(bufSize, length, infoLog); }
+    static GLint APIENTRY getUniformLocation(GLuint, const GLchar*) { recordAnswering(stubGetUniformLocation); return 0; }
+    static GLint APIENTRY getAttribLocation(GLuint, const GLchar*) { recordAnswering(stubGetAttribLocation); return 0; }
+    static void APIENTRY getVertexAttribiv(GLuint, GLenum, GLint* value) { recordAnswering(stubGetVertexAttribiv); *value = 0; }
+    static void APIENTRY getVertexAttribPointerv(GLuint, GLenum, void** pointer) { recordAnswering(stubGetVertexAttribPointerv); *pointer = nullptr; }
+
+    // queries are always finished and measured nothing
+    static void APIENTRY getQueryObjectiv(GLuint, GLenum pname, GLint* value) { recordAnswering(stubGetQueryObjectiv); *value = pname == GL_QUERY_RESULT_AVAILABLE ? 1 : 0; }
+    static void APIENTRY getQueryObjectuiv(GLuint, GLenum pname, GLuint* value) { recordAnswering(stubGetQueryObjectuiv); *value = pname == GL_QUERY_RESULT_AVAILABLE ? 1 : 0; }
+    static void APIENTRY getQueryObjecti64v(GLuint, GLenum, GLint64* value) { recordAnswering(stubGetQueryObjecti64v); *value = 0; }
+    static void APIENTRY getQueryObjectui64v(GLuint, GLenum, GLuint64* value) { recordAnswering(stubGetQueryObjectui64v); *value = 0; }
+
+    static GLsync APIENTRY fenceSync(GLenum, GLbitfield) { recordAnswering(stubFenceSync); return reinterpret_cast<GLsync>(static_cast<uintptr_t>(newName())); }
+    static GLenum APIENTRY clientWaitSync(GLsync, GLbitfield, GLuint64) { recordAnswering(stubClientWaitSync); return GL_ALREADY_SIGNALED; }
+
+    static void APIENTRY getSynciv(GLsync, GLenum pname, GLsizei bufSize, GLsizei* length, GLint* values) {
+        recordAnswering(stubGetSynciv);
+        if (length != nullptr)
+            *length = bufSize > 0 ? 1 : 0;
+        if (bufSize > 0)
+            values[0] = pname == GL_SYNC_STATUS ? GL_SIGNALED : 0;
+    }
+
+    static GLenum APIENTRY checkFramebufferStatus(GLenum) { recordAnswering(stubCheckFramebufferStatus); return GL_FRAMEBUFFER_COMPLETE; }
+
+    // mapped buffers point at scratch memory that is thrown away on unmap
+    static void* APIENTRY mapBufferRange(GLenum, GLintptr, GLsizeiptr length, GLbitfield) {
+        recordAnswering(stubMapBufferRange);
+        std::vector<unsigned char>& scratch = active()->mappedScratch;
+        if (scratch.size() < static_cast<size_t>(length))
+            scratch.resize(static_cast<size_t>(length));
+        return scratch.data();
+    }
+
+    static void* APIENTRY mapBuffer(GLenum, GLenum) { recordAnswering(stubMapBuffer); return nullptr; }
+    static GLboolean APIENTRY unmapBuffer(GLenum) { recordAnswering(stubUnmapBuffer); return GL_TRUE; }
+    static GLboolean APIENTRY isEnabled(GLenum) { recordAnswering(stubIsEnabled); return GL_FALSE; }
+    static GLboolean APIENTRY isProgram(GLuint) { recordAnswering(stubIsProgram); return GL_FALSE; }
+
+    struct answeringEntry {
+        const char* name;
+        answeringStub stub;
+        void* function;
+    };
+
+    static const answeringEntry* findAnswering(const char* name) {
+        static const answeringEntry entries[] = {
+            { "glGetString", stubGetString, reinterpret_cast<void*>(&getString) },
+            { "glGetStringi", stubGetStringi, reinterpret_cast<void*>(&getStringi) },
+            { "glGetIntegerv", stubGetIntegerv, reinterpret_cast<void*>(&getIntegerv) },
+            { "glGetFloatv", stubGetFloatv, reinterpret_cast<void*>(&getFloatv) },
+            { "glGetBooleanv", stubGetBooleanv, reinterpret_cast<void*>(&getBooleanv) },
+            { "glGetInteger64v", stubGetInteger64v, reinterpret_cast<void*>(&getInteger64v) },
+            { "glViewport", stubViewport, reinterpret_cast<void*>(&viewportStub) },
+            { "glGetError", stubGetError, reinterpret_cast<void*>(&getError) },
+            { "glCreateShader", stubCreateShader, reinterpret_cast<void*>(&createShader) },
+            { "glCreateProgram", stubCreateProgram, reinterpret_cast<void*>(&createProgram) },
+            { "glGenBuffers", stubGenBuffers, reinterpret_cast<void*>(&genBuffers) },
+            { "glGenVertexArrays", stubGenVertexArrays, reinterpret_cast<void*>(&genVertexArrays) },
+            { "glGenTextures", stubGenTextures, reinterpret_cast<void*>(&genTextures) },
+            { "glGenQueries", stubGenQueries, reinterpret_cast<void*>(&genQueries) },
+            { "glGenFramebuffers", stubGenFramebuffers, reinterpret_cast<void*>(&genFramebuffers) },
+            { "glGenRenderbuffers", stubGenRenderbuffers, reinterpret_cast<void*>(&genRenderbuffers) },
+            { "glGetShaderiv", stubGetShaderiv, reinterpret_cast<void*>(&getShaderiv) },
+            { "glGetProgramiv", stubGetProgramiv, reinterpret_cast<void*>(&getProgramiv) },
+            { "glGetShaderInfoLog", stubGetShaderInfoLog, reinterpret_cast<void*>(&getShaderInfoLog) },
+            { "glGetProgramInfoLog", stubGetProgramInfoLog, reinterpret_cast<void*>(&getProgramInfoLog) },
+            { "glGetUniformLocation", stubGetUniformLocation, reinterpret_cast<void*>(&getUniformLocation) },
+            { "glGetAttribLocation", stubGetAttribLocation, reinterpret_cast<void*>(&getAttribLocation) },
+            { "glGetVertexAttribiv", stubGetVertexAttribiv, reinterpret_cast<void*>(&getVertexAttribiv) },
+            { "glGetVertexAttribPointerv", stubGetVertexAttribPointerv, reinterpret_cast<void*>(&getVertexAttribPointerv) },
+            { "glGetQueryObjectiv", stubGetQueryObjectiv, reinterpret_cast<void*>(&getQueryObjectiv) },
+            { "glGetQueryObjectuiv", stubGetQueryObjectuiv, reinterpret_cast<void*>(&getQueryObjectuiv) },
+            { "glGetQueryObjecti64v", stubGetQueryObjecti64v, reinterpret_cast<void*>(&getQueryObjecti64v) },
+            { "glGetQueryObjectui64v", stubGetQueryObjectui64v, reinterpret_cast<void*>(&getQueryObjectui64v) },
+            { "glFenceSync", stubFenceSync, reinterpret_cast<void*>(&fenceSync) },
+            { "glClientWaitSync", stubClientWaitSync, reinterpret_cast<void*>(&clientWaitSync) },
+            { "glGetSynciv", stubGetSynciv, reinterpret_cast<void*>(&getSynciv) },
+            { "glCheckFramebufferStatus", stubCheckFramebufferStatus, reinterpret_cast<void*>(&checkFramebufferStatus) },
+            { "glMapBufferRange", stubMapBufferRange, reinterpret_cast<void*>(&mapBufferRange) },
+            { "glMapBuffer", stubMapBuffer, reinterpret_cast<void*>(&mapBuffer) },
+            { "glUnmapBuffer", stubUnmapBuffer, reinterpret_cast<void*>(&unmapBuffer) },
+            { "glIsEnabled", stubIsEnabled, reinterpret_cast<void*>(&isEnabled) },
+            { "glIsProgram", stubIsProgram, reinterpret_cast<void*>(&isProgram) },
+        };
+        for (const answeringEntry& entry : entries) {
+            if (std::strcmp(entry.name, name) == 0)
+                return &entry;
+        }
+        return nullptr;
+    }
+
+    // GLADloadproc. glad asks for each entry point once, each one gets the next command id.
+    static void* getProcAddress(const char* name) {
+        nullGL* gl = active();
+        if (gl == nullptr)
+            return nullptr;
+
+        for (int id = 0; id < gl->commandCount; id++) {
+            if (std::strcmp(gl->commandNames[id], name) == 0)
+                return gl->lookup(id, name);
+        }
+        if (gl->commandCount >= maxCommands)
+            return nullptr;
+
+        int id = gl->commandCount++;
+        gl->commandNames[id] = name;
+        return gl->lookup(id, name);
+    }
+
+    void* lookup(int id, const char* name) {
+        if (const answeringEntry* entry = findAnswering(name)) {
+            answeringId(entry->stub) = id;
+            return entry->function;
+        }
+        return countedStubAt(id, std::make_index_sequence<maxCommands>());
+    }
+};
@@ -0,0 +1,73 @@
+#pragma once
+#include <iostream>
+#include "miniaudio.h"
+#include "assetPack.h"
+
+// The --wav-sounds sounds played straight out of the asset pack. Each sound gets a few voices so it can overlap
+// itself, and every voice's buffer points at the same PCM in the mapping, nothing is decoded or copied.
+template <int soundCount>
+class packedSoundBank {
+public:
+    static const int voiceCount = 3;
+    ma_audio_buffer buffers[soundCount][voiceCount];
+    ma_sound sounds[soundCount][voiceCount];
+    int initializedVoices[soundCount] = {};
+    bool ready = false;
+
+    // false if any sound is missing from the pack or doesn't hold the frames it says, the caller falls back to loose files then
+    bool init(ma_engine* engine, const assetPack& pack, const char* const (&names)[soundCount]) {
+        for (int sound = 0; sound < soundCount; sound++) {
+            const assetPackEntry* entry = pack.find(names[sound]);
+            if (entry == nullptr || entry->type != assetPcmF32) {
+                std::cout << names[sound] << " isn't in the asset pack" << std::endl;
+                uninit();
+                return false;
+            }
+            // the voices read frameCount frames straight out of the mapping, a short entry would run them off the end
+            if (entry->channels == 0 || static_cast<uint64_t>(entry->frameCount) * entry->channels * sizeof(float) > entry->size) {
+                std::cout << names[sound] << " in the asset pack is shorter than its frame count" << std::endl;
+                uninit();
+                return false;
+            }
+
+            ma_audio_buffer_config config = ma_audio_buffer_config_init(ma_format_f32, entry->channels, entry->frameCount, pack.data(entry), NULL);
+            config.sampleRate = entry->sampleRate; // the engine resamples if its device runs at another rate
+            for (int voice = 0; voice < voiceCount; voice++) {
+                if (ma_audio_buffer_init(&config, &buffers[sound][voice]) != MA_SUCCESS) {
+                    uninit();
+                    return false;
+                }
+                if (ma_sound_init_from_data_source(engine, &buffers[sound][voice], MA_SOUND_FLAG_NO_SPATIALIZATION, NULL, &sounds[sound][voice]) != MA_SUCCESS) {
+                    ma_audio_buffer_uninit(&buffers[sound][voice]);
+                    uninit();
+                    return false;
+                }
+                initializedVoices[sound]++;
+            }
+        }
+        ready = true;
+        return true;
+    }
+
+    void play(int sound) {
+        for (int voice = 0; voice < initializedVoices[sound]; voice++) {
+            if (ma_sound_is_playing(&sounds[sound][voice]))
+                continue;
+            ma_sound_seek_to_pcm_frame(&sounds[sound][voice], 0);
+            ma_sound_start(&sounds[sound][voice]);
+            return;
+        }
+        // every voice is busy, drop the sound rather than cut one off
+    }
+
+    void uninit() {
+        for (int sound = 0; sound < soundCount; sound++) {
+            for (int voice = 0; voice < initializedVoices[sound]; voice++) {
+                ma_sound_uninit(&sounds[sound][voice]);
+                ma_audio_buffer_uninit(&buffers[sound][voice]);
+            }
+            initializedVoices[sound] = 0;
+        }
+        ready = false;
+    }
+};
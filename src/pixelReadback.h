@@ -0,0 +1,134 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <glad/glad.h>
+
+// Reads frames back through a ring of pixel pack buffers so the game thread never waits on glReadPixels.
+// capture() starts the copy on the GPU and drops a fence, poll() hands finished frames to the consumer.
+// The buffers are persistently mapped (GL 4.4), so a worker thread reads the pixels straight out of them
+// and calls release() when done; the game thread never copies a frame itself.
+class pixelReadback {
+public:
+    static const int maxSlots = 8;
+
+    enum slotState { slotFree, slotPending, slotReady };
+
+    struct slot {
+        GLuint pbo = 0;
+        const uint8_t* pixels = nullptr;
+        GLsync fence = nullptr;
+        uint64_t frameIndex = 0;
+        std::atomic<int> state{ slotFree };
+    };
+
+    slot slots[maxSlots];
+    int slotCount = 0;
+    int width = 0;
+    int height = 0;
+    int next = 0;    // slot the next capture goes into
+    int oldest = 0;  // oldest slot still waiting on the GPU
+    uint64_t stalls = 0; // captures that had to wait for a slot
+
+    size_t frameBytes() const { return static_cast<size_t>(width) * height * 4; }
+
+    bool init(int width, int height, int slotCount) {
+        if (!GLAD_GL_VERSION_4_4)
+            return false;
+
+        this->width = width;
+        this->height = height;
+        this->slotCount = slotCount < maxSlots ? slotCount : maxSlots;
+
+        const GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        for (int i = 0; i < this->slotCount; i++) {
+            glGenBuffers(1, &slots[i].pbo);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slots[i].pbo);
+            glBufferStorage(GL_PIXEL_PACK_BUFFER, frameBytes(), nullptr, flags);
+            slots[i].pixels = static_cast<const uint8_t*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, frameBytes(), flags));
+            slots[i].state.store(slotFree);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        next = 0;
+        oldest = 0;
+        return true;
+    }
+
+    // called by whoever consumed a ready frame, from any thread
+    void release(int index) {
+        slots[index].state.store(slotFree, std::memory_order_release);
+    }
+
+    bool fenceSignalled(slot& s, GLuint64 timeout) {
+        GLenum status = glClientWaitSync(s.fence, timeout > 0 ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, timeout);
+        return status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED;
+    }
+
+    // hands every finished capture, oldest first, to onReady(slotIndex, pixels, width, height, frameIndex).
+    // The consumer owns the slot until it calls release().
+    template <typename OnReady>
+    void poll(OnReady&& onReady, bool wait = false) {
+        while (slots[oldest].state.load(std::memory_order_acquire) == slotPending) {
+            slot& s = slots[oldest];
+            if (!fenceSignalled(s, wait ? 1000000000ull : 0))
+                return;
+            glDeleteSync(s.fence);
+            s.fence = nullptr;
+            s.state.store(slotReady, std::memory_order_release);
+            onReady(oldest, s.pixels, width, height, s.frameIndex);
+            oldest = (oldest + 1) % slotCount;
+        }
+    }
+
+    // copies the given framebuffer (0 and GL_BACK for the window) into the next slot.
+    // If that slot is still in use we wait for it rather than drop the frame.
+    template <typename OnReady>
+    void capture(GLuint framebuffer, GLenum readBuffer, uint64_t frameIndex, OnReady&& onReady) {
+        slot& s = slots[next];
+        if (s.state.load(std::memory_order_acquire) != slotFree) {
+            stalls++;
+            while (s.state.load(std::memory_order_acquire) == slotPending)
+                poll(onReady, true);
+            while (s.state.load(std::memory_order_acquire) != slotFree)
+                std::this_thread::yield();
+        }
+
+        GLint previousFramebuffer = 0;
+        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousFramebuffer);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+        glReadBuffer(readBuffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, s.pbo);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, previousFramebuffer);
+
+        s.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        s.frameIndex = frameIndex;
+        s.state.store(slotPending, std::memory_order_release);
+        next = (next + 1) % slotCount;
+    }
+
+    // waits for everything in flight and hands it over. The consumer still has to release the slots.
+    template <typename OnReady>
+    void finish(OnReady&& onReady) {
+        poll(onReady, true);
+    }
+
+    // call once every slot has been released
+    void shutdown() {
+        for (int i = 0; i < slotCount; i++) {
+            if (slots[i].fence != nullptr)
+                glDeleteSync(slots[i].fence);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slots[i].pbo);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            glDeleteBuffers(1, &slots[i].pbo);
+            slots[i].pbo = 0;
+            slots[i].pixels = nullptr;
+            slots[i].fence = nullptr;
+            slots[i].state.store(slotFree);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        slotCount = 0;
+    }
+};
@@ -0,0 +1,196 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Small RGBA8 PNG encoder for frame dumps, so we don't need another library. Deflate uses the fixed Huffman
+// table with a single-probe LZ77 hash, which is plenty for our flat coloured frames.
+class pngWriter {
+public:
+    std::vector<uint8_t> raw;        // filtered scanlines
+    std::vector<uint8_t> compressed; // zlib stream
+    std::vector<int32_t> head;       // last position each 3 byte hash was seen at
+
+    uint32_t bitBuffer = 0;
+    int bitCount = 0;
+
+    static uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+        static uint32_t table[256] = {};
+        if (table[1] == 0) {
+            for (uint32_t n = 0; n < 256; n++) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; k++)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                table[n] = c;
+            }
+        }
+        crc = ~crc;
+        for (size_t i = 0; i < size; i++)
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return ~crc;
+    }
+
+    static uint32_t adler32(const uint8_t* data, size_t size) {
+        uint32_t a = 1, b = 0;
+        while (size > 0) {
+            size_t block = size < 5552 ? size : 5552;
+            size -= block;
+            while (block-- > 0) {
+                a += *data++;
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+        }
+        return (b << 16) | a;
+    }
+
+    void putBits(uint32_t value, int count) {
+        bitBuffer |= value << bitCount;
+        bitCount += count;
+        while (bitCount >= 8) {
+            compressed.push_back(static_cast<uint8_t>(bitBuffer));
+            bitBuffer >>= 8;
+            bitCount -= 8;
+        }
+    }
+
+    // Huffman codes go in most significant bit first
+    void putCode(uint32_t code, int length) {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; i++)
+            reversed |= ((code >> i) & 1) << (length - 1 - i);
+        putBits(reversed, length);
+    }
+
+    void putLiteral(int value) {
+        if (value < 144) putCode(0x30 + value, 8);
+        else if (value < 256) putCode(0x190 + value - 144, 9);
+        else if (value < 280) putCode(value - 256, 7);
+        else putCode(0xC0 + value - 280, 8);
+    }
+
+    void putMatch(int length, int distance) {
+        static const int lengthBase[29] = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258 };
+        static const int lengthExtra[29] = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+        static const int distanceBase[30] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+        static const int distanceExtra[30] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+
+        int l = 28;
+        while (lengthBase[l] > length)
+            l--;
+        putLiteral(257 + l);
+        putBits(length - lengthBase[l], lengthExtra[l]);
+
+        int d = 29;
+        while (distanceBase[d] > distance)
+            d--;
+        putCode(d, 5);
+        putBits(distance - distanceBase[d], distanceExtra[d]);
+    }
+
+    void deflate(const uint8_t* data, size_t size) {
+        const int hashBits = 15;
+        const int windowSize = 32768;
+        const int maxMatch = 258;
+        head.assign(size_t(1) << hashBits, -1);
+
+        compressed.push_back(0x78); // zlib header: deflate, 32K window, fastest
+        compressed.push_back(0x01);
+        bitBuffer = 0;
+        bitCount = 0;
+        putBits(1, 1); // last block
+        putBits(1, 2); // fixed Huffman
+
+        size_t pos = 0;
+        while (pos < size) {
+            int bestLength = 0;
+            int distance = 0;
+            if (pos + 3 <= size) {
+                uint32_t hash = ((data[pos] << 16) | (data[pos + 1] << 8) | data[pos + 2]) * 2654435761u >> (32 - hashBits);
+                int32_t candidate = head[hash];
+                head[hash] = static_cast<int32_t>(pos);
+
+                if (candidate >= 0 && pos - candidate <= windowSize) {
+                    size_t limit = size - pos < maxMatch ? size - pos : maxMatch;
+                    size_t length = 0;
+                    while (length < limit && data[candidate + length] == data[pos + length])
+                        length++;
+                    if (length >= 3) {
+                        bestLength = static_cast<int>(length);
+                        distance = static_cast<int>(pos - candidate);
+                    }
+                }
+            }
+
+            if (bestLength > 0) {
+                putMatch(bestLength, distance);
+                pos += bestLength;
+            }
+            else {
+                putLiteral(data[pos]);
+                pos++;
+            }
+        }
+        putLiteral(256); // end of block
+        putBits(0, 7);   // flush the last partial byte
+
+        uint32_t adler = adler32(data, size);
+        for (int shift = 24; shift >= 0; shift -= 8)
+            compressed.push_back(static_cast<uint8_t>(adler >> shift));
+    }
+
+    static void writeChunk(FILE* file, const char* type, const uint8_t* data, size_t size) {
+        uint8_t header[8] = {
+            uint8_t(size >> 24), uint8_t(size >> 16), uint8_t(size >> 8), uint8_t(size),
+            uint8_t(type[0]), uint8_t(type[1]), uint8_t(type[2]), uint8_t(type[3])
+        };
+        uint32_t crc = crc32(header + 4, 4);
+        crc = crc32(data, size, crc);
+        uint8_t footer[4] = { uint8_t(crc >> 24), uint8_t(crc >> 16), uint8_t(crc >> 8), uint8_t(crc) };
+        fwrite(header, 1, 8, file);
+        if (size > 0)
+            fwrite(data, 1, size, file);
+        fwrite(footer, 1, 4, file);
+    }
+
+    // stride can be negative to write a bottom-up image (what glReadPixels gives) the right way up
+    bool write(const std::string& path, const uint8_t* rgba, int width, int height, int stride) {
+        size_t rowBytes = static_cast<size_t>(width) * 4;
+        raw.resize((rowBytes + 1) * height);
+        for (int y = 0; y < height; y++) {
+            uint8_t* row = &raw[(rowBytes + 1) * y];
+            const uint8_t* source = rgba + static_cast<std::ptrdiff_t>(stride) * y;
+            row[0] = 1; // Sub filter: flat colours turn into runs of zeros
+            for (size_t x = 0; x < 4 && x < rowBytes; x++)
+                row[1 + x] = source[x];
+            for (size_t x = 4; x < rowBytes; x++)
+                row[1 + x] = static_cast<uint8_t>(source[x] - source[x - 4]);
+        }
+
+        compressed.clear();
+        deflate(raw.data(), raw.size());
+
+        FILE* file = fopen(path.c_str(), "wb");
+        if (file == nullptr)
+            return false;
+
+        static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        fwrite(signature, 1, 8, file);
+
+        uint8_t ihdr[13] = {
+            uint8_t(width >> 24), uint8_t(width >> 16), uint8_t(width >> 8), uint8_t(width),
+            uint8_t(height >> 24), uint8_t(height >> 16), uint8_t(height >> 8), uint8_t(height),
+            8, 6, 0, 0, 0 // 8 bit RGBA, deflate, adaptive filtering, no interlace
+        };
+        writeChunk(file, "IHDR", ihdr, sizeof(ihdr));
+        writeChunk(file, "IDAT", compressed.data(), compressed.size());
+        writeChunk(file, "IEND", nullptr, 0);
+
+        bool ok = ferror(file) == 0;
+        fclose(file);
+        return ok;
+    }
+};
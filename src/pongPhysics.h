@@ -0,0 +1,79 @@
+#pragma once
+#include <cmath>
+#include <random>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// The gameplay maths with no GL or audio attached, so pong_bench can run exactly what the game runs.
+
+inline float randomFloat(std::mt19937& gen, float min, float max) {
+    std::uniform_real_distribution<float> dis(min, max); // range [0.0, 1.0)
+
+    return dis(gen);
+}
+
+// picks a new random direction for the ball, same total speed every serve. The game seeds gen once at startup
+// and pong_bench with a fixed seed, neither pays for a std::random_device per serve.
+inline void serveSpeeds(std::mt19937& gen, float& speedX, float& speedZ) {
+    const float maxSpeed = 2.0f;
+    const float minXSpeed = 0.5f;
+    const float maxXSpeed = 1.5f;
+
+    do {
+        speedX = randomFloat(gen, -maxSpeed, maxSpeed);
+    } while (std::abs(speedX) < minXSpeed || std::abs(speedX) > maxXSpeed);
+
+    float remainingSpeed = sqrt(maxSpeed * maxSpeed - speedX * speedX);
+    // Randomize direction of speedZ for variety
+    speedZ = (randomFloat(gen, 0.0f, 1.0f) > 0.5f) ? remainingSpeed : -remainingSpeed;
+}
+
+
+// do two cubes overlap on the table (x and z, y is ignored)
+inline bool cubesOverlap(const glm::vec3& a, const glm::vec3& aScale, const glm::vec3& b, const glm::vec3& bScale) {
+    return a.x - (aScale.x / 2) < b.x + (bScale.x / 2) &&
+        a.x + (aScale.x / 2) > b.x - (bScale.x / 2) &&
+        a.z - (aScale.z / 2) < b.z + (bScale.z / 2) &&
+        a.z + (aScale.z / 2) > b.z - (bScale.z / 2);
+}
+
+// ball is touching a paddle: reflect off whichever side it went in the least, and speed it up a bit.
+// movingTowardPaddle stops the ball bouncing back into the paddle it just left.
+inline void paddleBounce(const glm::vec3& ball, const glm::vec3& ballScale, const glm::vec3& paddle, const glm::vec3& paddleScale,
+    bool movingTowardPaddle, float& speedX, float& speedZ, bool& hasBouncedX, bool& hasBouncedZ) {
+    float overlapX = 0.0f;
+    if (ball.x < paddle.x) {
+        overlapX = (ball.x + ballScale.x / 2) - (paddle.x - paddleScale.x / 2);
+    }
+    else {
+        overlapX = (paddle.x + paddleScale.x / 2) - (ball.x - ballScale.x / 2);
+    }
+
+    float overlapZ = 0.0f;
+    if (ball.z < paddle.z) {
+        overlapZ = (ball.z + ballScale.z / 2) - (paddle.z - paddleScale.z / 2);
+    }
+    else {
+        overlapZ = (paddle.z + paddleScale.z / 2) - (ball.z - ballScale.z / 2);
+    }
+
+    // Reflect speeds based on which overlap is smaller (collision axis)
+    if (overlapX < overlapZ && movingTowardPaddle && !hasBouncedX) {
+        (speedX > 0 ? speedX += 0.1f : speedX -= 0.1f);
+        speedX = -speedX;
+        hasBouncedX = true;
+    }
+    else if (overlapZ < overlapX && !hasBouncedZ) {
+        (speedZ > 0 ? speedZ += 0.1f : speedZ -= 0.1f);
+        speedZ = -speedZ;
+        hasBouncedZ = true;
+    }
+}
+
+// model matrix for a cube drawn alpha of the way from its previous to its current position
+inline glm::mat4 cubeModelMatrix(const glm::vec3& previousPosition, const glm::vec3& position, const glm::vec3& scale, float alpha) {
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, glm::mix(previousPosition, position, alpha));
+    model = glm::scale(model, scale);
+    return model;
+}
@@ -0,0 +1,238 @@
+#pragma once
+#include <cmath>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include "ecs.h"
+#include "jobSystem.h"
+
+// The game's components and the systems that only need them, no GL, input or audio, so pong_bench can run them.
+// Systems that walk a lot of entities hand their chunks out over the job system.
+// The pong rules themselves (serving, scoring, sounds) stay in mainScreen and work on the ball entity directly.
+
+// where something is, where it was one step earlier (for interpolating), and its size
+struct transform {
+    glm::vec3 position;
+    glm::vec3 previousPosition;
+    glm::vec3 scale;
+};
+
+inline transform placedAt(glm::vec3 position, glm::vec3 scale) {
+    return { position, position, scale };
+}
+
+// units per second, moved by movementSystem every step
+struct velocity {
+    glm::vec3 value;
+};
+
+// solid on the table, x and z, the same footprint as the transform's scale. Without a velocity it's something
+// others bounce off (walls, paddles).
+struct aabbCollider {
+    glm::vec3 size;
+};
+
+// moved along z by a player's keys
+struct paddleControl {
+    int player;      // 0 = W/S, 1 = the arrow keys
+    float speed;     // units per second held
+    float minZ;
+    float maxZ;
+};
+
+// bounces off every collider without a velocity and nothing else happens, the sandbox balls
+struct bouncer {
+    int unused;
+};
+
+// which of the render side's models draws it
+enum renderModelId { modelFloor, modelWall, modelBall, modelPaddle, modelCount };
+
+struct renderable {
+    int model;
+};
+
+// one drawn copy of a model, interpolated on the render side
+struct renderInstance {
+    glm::vec3 previousPosition;
+    glm::vec3 position;
+    glm::vec3 scale;
+};
+
+// What the systems keep from one step to the next, so a step doesn't allocate. Only one system uses it at a time.
+struct systemScratch {
+    std::vector<ecsWorld::chunkRef> chunks;
+    std::vector<transform> obstacles;
+    std::vector<int> instanceOffsets; // per chunk and model
+};
+
+// f(count, C* arrays...) for every chunk with all of C, spread over the job system a few chunks per job
+template <typename... C, typename F>
+void parallelEachChunk(ecsWorld& world, jobSystem& jobs, systemScratch& scratch, const F& f) {
+    const int chunksPerJob = 4;
+    world.matchingChunks<C...>(scratch.chunks);
+    const std::vector<ecsWorld::chunkRef>& chunks = scratch.chunks;
+    jobs.parallelFor(static_cast<int>(chunks.size()), chunksPerJob, [&chunks, &f](int begin, int end) {
+        for (int i = begin; i < end; i++)
+            f(chunks[i].data->count, chunks[i].owner->template array<C>(*chunks[i].data)...);
+    });
+}
+
+// before anything moves in a step
+inline void savePositionSystem(ecsWorld& world, jobSystem& jobs, systemScratch& scratch) {
+    parallelEachChunk<transform>(world, jobs, scratch, [](int count, transform* transforms) {
+        for (int i = 0; i < count; i++)
+            transforms[i].previousPosition = transforms[i].position;
+    });
+}
+
+inline void movementSystem(ecsWorld& world, jobSystem& jobs, systemScratch& scratch, float deltaTime) {
+    parallelEachChunk<transform, velocity>(world, jobs, scratch, [deltaTime](int count, transform* transforms, velocity* velocities) {
+        for (int i = 0; i < count; i++)
+            transforms[i].position += velocities[i].value * deltaTime;
+    });
+}
+
+// Bouncers against every static collider. There are only ever a handful of those (walls and paddles), so they're
+// gathered into one small array first and each chunk of bouncers runs straight through it.
+inline void bounceSystem(ecsWorld& world, jobSystem& jobs, systemScratch& scratch) {
+    std::vector<transform>& obstacles = scratch.obstacles;
+    obstacles.clear();
+    uint32_t moving = componentMask<velocity>();
+    for (ecsWorld::archetype& a : world.archetypes) {
+        if ((a.mask & componentMask<transform, aabbCollider>()) != componentMask<transform, aabbCollider>() || (a.mask & moving) != 0)
+            continue;
+        for (ecsWorld::chunk& c : a.chunks) {
+            transform* transforms = a.array<transform>(c);
+            aabbCollider* colliders = a.array<aabbCollider>(c);
+            for (int i = 0; i < c.count; i++)
+                obstacles.push_back({ transforms[i].position, transforms[i].position, colliders[i].size });
+        }
+    }
+
+    const transform* first = obstacles.data();
+    const transform* last = first + obstacles.size();
+    parallelEachChunk<transform, velocity, aabbCollider, bouncer>(world, jobs, scratch, [first, last](int count,
+        transform* transforms, velocity* velocities, aabbCollider* colliders, bouncer*) {
+        for (int i = 0; i < count; i++) {
+            glm::vec3 position = transforms[i].position;
+            glm::vec3 size = colliders[i].size;
+            glm::vec3 speed = velocities[i].value;
+            for (const transform* obstacle = first; obstacle != last; obstacle++) {
+                // how far it's in on each axis, both positive when they overlap (cubesOverlap's test)
+                float overlapX = (size.x + obstacle->scale.x) / 2 - std::abs(position.x - obstacle->position.x);
+                float overlapZ = (size.z + obstacle->scale.z) / 2 - std::abs(position.z - obstacle->position.z);
+                if (overlapX <= 0.0f || overlapZ <= 0.0f)
+                    continue;
+                // out along whichever axis it went in the least, and only if it's still heading in
+                if (overlapX < overlapZ) {
+                    if ((position.x < obstacle->position.x) == (speed.x > 0))
+                        speed.x = -speed.x;
+                }
+                else if ((position.z < obstacle->position.z) == (speed.z > 0))
+                    speed.z = -speed.z;
+            }
+            velocities[i].value = speed;
+        }
+    });
+}
+
+// Everything drawn, bucketed by model, into a snapshot's instance lists. Two passes so the chunks can be spread
+// over threads: count each chunk's instances per model, then each chunk writes its own slice of the lists. The
+// lists are resized rather than cleared, so in a steady scene nothing gets allocated or zeroed.
+inline void renderExtractionSystem(ecsWorld& world, jobSystem& jobs, systemScratch& scratch, std::vector<renderInstance> (&instances)[modelCount]) {
+    world.matchingChunks<transform, renderable>(scratch.chunks);
+    const std::vector<ecsWorld::chunkRef>& chunks = scratch.chunks;
+    std::vector<int>& offsets = scratch.instanceOffsets;
+    offsets.assign(chunks.size() * modelCount, 0);
+
+    jobs.parallelFor(static_cast<int>(chunks.size()), 4, [&chunks, &offsets](int begin, int end) {
+        for (int c = begin; c < end; c++) {
+            const renderable* renderables = chunks[c].owner->array<renderable>(*chunks[c].data);
+            int* counts = &offsets[c * modelCount];
+            for (int i = 0; i < chunks[c].data->count; i++)
+                counts[renderables[i].model]++;
+        }
+    });
+
+    for (int model = 0; model < modelCount; model++) {
+        int total = 0;
+        for (size_t c = 0; c < chunks.size(); c++) {
+            int count = offsets[c * modelCount + model];
+            offsets[c * modelCount + model] = total;
+            total += count;
+        }
+        instances[model].resize(total);
+    }
+
+    renderInstance* lists[modelCount];
+    for (int model = 0; model < modelCount; model++)
+        lists[model] = instances[model].data();
+    jobs.parallelFor(static_cast<int>(chunks.size()), 4, [&chunks, &offsets, &lists](int begin, int end) {
+        for (int c = begin; c < end; c++) {
+            const transform* transforms = chunks[c].owner->array<transform>(*chunks[c].data);
+            const renderable* renderables = chunks[c].owner->array<renderable>(*chunks[c].data);
+            int next[modelCount];
+            for (int model = 0; model < modelCount; model++)
+                next[model] = offsets[c * modelCount + model];
+            for (int i = 0; i < chunks[c].data->count; i++) {
+                renderInstance& out = lists[renderables[i].model][next[renderables[i].model]++];
+                out.previousPosition = transforms[i].previousPosition;
+                out.position = transforms[i].position;
+                out.scale = transforms[i].scale;
+            }
+        }
+    });
+}
+
+// the entities the pong rules work on
+struct arenaEntities {
+    entity ball;
+    entity leftPaddle;
+    entity rightPaddle;
+};
+
+// the ball and paddles' sizes and where the paddles stand, pong_bench times the collisions with the same ones
+const glm::vec3 arenaBallScale(0.25f, 0.25f, 0.25f);
+const glm::vec3 arenaPaddleScale(0.10f, 0.25f, 0.40f);
+const glm::vec3 arenaLeftPaddle(1.0f, -0.75f, 1.25f);
+const glm::vec3 arenaRightPaddle(-1.0f, -0.75f, 1.25f);
+
+// the table, its four walls, the ball and both paddles
+inline arenaEntities spawnArena(ecsWorld& world) {
+    world.create(placedAt(glm::vec3(0.0f, -0.75f, 1.25f), glm::vec3(3.0f, 0.1f, 2.0f)), renderable{ modelFloor });
+
+    const glm::vec3 walls[4][2] = {
+        { glm::vec3(0.0f, -0.75f, 2.25f), glm::vec3(3.0f, 0.3f, 0.3f) },
+        { glm::vec3(0.0f, -0.75f, 0.25f), glm::vec3(3.0f, 0.3f, 0.3f) },
+        { glm::vec3(1.5f, -0.75f, 1.25f), glm::vec3(0.3f, 0.3f, 2.3f) },
+        { glm::vec3(-1.5f, -0.75f, 1.25f), glm::vec3(0.3f, 0.3f, 2.3f) },
+    };
+    for (const glm::vec3* wall : walls)
+        world.create(placedAt(wall[0], wall[1]), aabbCollider{ wall[1] }, renderable{ modelWall });
+
+    arenaEntities arena;
+    arena.ball = world.create(placedAt(glm::vec3(0.0f, -0.575f, 1.25f), arenaBallScale), velocity{ glm::vec3(0.0f) },
+        aabbCollider{ arenaBallScale }, renderable{ modelBall });
+
+    arena.leftPaddle = world.create(placedAt(arenaLeftPaddle, arenaPaddleScale), aabbCollider{ arenaPaddleScale },
+        paddleControl{ 0, 0.75f, 0.6f, 1.9f }, renderable{ modelPaddle });
+    arena.rightPaddle = world.create(placedAt(arenaRightPaddle, arenaPaddleScale), aabbCollider{ arenaPaddleScale },
+        paddleControl{ 1, 0.75f, 0.6f, 1.9f }, renderable{ modelPaddle });
+    return arena;
+}
+
+// n small balls scattered over the table at the ball's speed, for stress testing with --sandbox
+inline void spawnSandboxBalls(ecsWorld& world, int n) {
+    std::mt19937 random(12345); // the same scene every run
+    std::uniform_real_distribution<float> x(-1.2f, 1.2f);
+    std::uniform_real_distribution<float> z(0.55f, 1.95f);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    const glm::vec3 size(0.03f);
+    for (int i = 0; i < n; i++) {
+        float direction = angle(random);
+        world.create(placedAt(glm::vec3(x(random), -0.6f, z(random)), size),
+            velocity{ glm::vec3(std::cos(direction), 0.0f, std::sin(direction)) * 2.0f },
+            aabbCollider{ size }, bouncer{ 0 }, renderable{ modelBall });
+    }
+}
@@ -0,0 +1,166 @@
+#pragma once
+// Scoped CPU zones, dumped in Chrome trace event format (open the file in Perfetto or chrome://tracing).
+//
+//     PROFILE_ZONE("mainScreen::Render");
+//
+// Zones only exist when PONG_PROFILE is defined (it is in the Debug configurations), otherwise the
+// macro compiles to nothing. Even then nothing is recorded until profiler::start() is called (--trace=file.json).
+// Each thread writes into its own buffer, so recording a zone is two timestamp reads and a store.
+
+#ifdef PONG_PROFILE
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "gameClock.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILER_HAS_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILER_HAS_RDTSC 1
+#endif
+
+class profiler {
+public:
+    struct zoneEvent {
+        const char* name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    struct threadBuffer {
+        static const uint32_t capacity = 1 << 18;
+        zoneEvent events[capacity];
+        std::atomic<uint32_t> count{ 0 };
+        uint32_t dropped = 0;
+        uint32_t threadId = 0;
+    };
+
+    static uint64_t ticks() {
+#ifdef PROFILER_HAS_RDTSC
+        return __rdtsc();
+#else
+        return nowNanoseconds();
+#endif
+    }
+
+    static std::atomic<bool>& recording() {
+        static std::atomic<bool> value{ false };
+        return value;
+    }
+
+    static std::mutex& registryMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::vector<threadBuffer*>& registry() {
+        static std::vector<threadBuffer*> buffers;
+        return buffers;
+    }
+
+    // tick/nanosecond pairs taken at start() and dump() to convert rdtsc ticks to time
+    static uint64_t& startTicks() { static uint64_t value = 0; return value; }
+    static uint64_t& startNanoseconds() { static uint64_t value = 0; return value; }
+
+    static threadBuffer* currentThreadBuffer() {
+        thread_local threadBuffer* buffer = nullptr;
+        if (buffer == nullptr) {
+            buffer = new threadBuffer();
+            std::lock_guard<std::mutex> lock(registryMutex());
+            buffer->threadId = static_cast<uint32_t>(registry().size()) + 1;
+            registry().push_back(buffer);
+        }
+        return buffer;
+    }
+
+    static void start() {
+        currentThreadBuffer(); // allocate the calling thread's buffer now rather than inside the first zone
+        startTicks() = ticks();
+        startNanoseconds() = nowNanoseconds();
+        recording().store(true, std::memory_order_release);
+    }
+
+    static void record(const char* name, uint64_t start, uint64_t end) {
+        threadBuffer* buffer = currentThreadBuffer();
+        uint32_t index = buffer->count.load(std::memory_order_relaxed);
+        if (index >= threadBuffer::capacity) {
+            buffer->dropped++;
+            return;
+        }
+        buffer->events[index] = { name, start, end };
+        buffer->count.store(index + 1, std::memory_order_release);
+    }
+
+    // writes everything recorded so far as a Chrome trace
+    static bool dump(const char* path) {
+        recording().store(false, std::memory_order_release);
+
+        uint64_t endTicks = ticks();
+        uint64_t endNanoseconds = nowNanoseconds();
+        double nanosecondsPerTick = endTicks > startTicks()
+            ? static_cast<double>(endNanoseconds - startNanoseconds()) / (endTicks - startTicks())
+            : 1.0;
+
+        std::ofstream out(path);
+        if (!out)
+            return false;
+
+        // fixed to the nanosecond: the default 6 significant digits would round ts to 10 us steps after a second
+        out << std::fixed << std::setprecision(3);
+        out << "{\"traceEvents\":[\n";
+        bool first = true;
+
+        std::lock_guard<std::mutex> lock(registryMutex());
+        for (threadBuffer* buffer : registry()) {
+            uint32_t count = buffer->count.load(std::memory_order_acquire);
+            for (uint32_t i = 0; i < count; i++) {
+                const zoneEvent& event = buffer->events[i];
+                double startMicroseconds = (event.start - startTicks()) * nanosecondsPerTick / 1000.0;
+                double durationMicroseconds = (event.end - event.start) * nanosecondsPerTick / 1000.0;
+
+                out << (first ? "" : ",\n")
+                    << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->threadId
+                    << ",\"ts\":" << startMicroseconds << ",\"dur\":" << durationMicroseconds << "}";
+                first = false;
+            }
+            if (buffer->dropped > 0)
+                std::cout << "Profiler thread " << buffer->threadId << " dropped " << buffer->dropped << " zones, buffer full" << std::endl;
+        }
+
+        out << "\n]}\n";
+        return true;
+    }
+};
+
+class profileZone {
+public:
+    const char* name;
+    uint64_t start;
+
+    explicit profileZone(const char* name) : name(name) {
+        start = profiler::recording().load(std::memory_order_relaxed) ? profiler::ticks() : 0;
+    }
+
+    ~profileZone() {
+        if (start != 0)
+            profiler::record(name, start, profiler::ticks());
+    }
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) profileZone PROFILE_CONCAT(profileZone_, __LINE__)(name)
+
+#else
+
+#define PROFILE_ZONE(name) ((void)0)
+
+#endif
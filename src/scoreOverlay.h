@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include "sdfText.h"
+
+// The scores and the serve countdown over the arena, as sdfText labels: one draw call, and the quads are only
+// laid out again when a number changes. Sizes and positions match the ImGui text this replaced.
+class scoreHud {
+public:
+    sdfText text;
+    int leftScore = -1;
+    int rightScore = -1;
+    int countdown = -1;
+
+    bool loadFont(const unsigned char* ttf) {
+        return text.loadFont(ttf);
+    }
+
+    bool init() {
+        if (!text.init())
+            return false;
+        const uint32_t yellow = 0xFF00FFFF; // RGBA bytes, red first
+        const uint32_t magenta = 0xFFFF00FF;
+        leftScore = text.addLabel(120.0f, yellow, 0.5f);
+        rightScore = text.addLabel(120.0f, yellow, 0.5f);
+        countdown = text.addLabel(120.0f, magenta, 0.5f);
+        return true;
+    }
+
+    void shutdown() {
+        text.shutdown();
+    }
+
+    // returns the triangles drawn
+    int draw(int leftPlayerScore, int rightPlayerScore, bool counting, int countdownValue, float windowWidth, float windowHeight) {
+        float centre = windowWidth * 0.5f;
+        text.setNumber(leftScore, leftPlayerScore);
+        text.setPosition(leftScore, centre - 200.0f, 150.0f);
+        text.setNumber(rightScore, rightPlayerScore);
+        text.setPosition(rightScore, centre + 200.0f, 150.0f);
+        text.setNumber(countdown, countdownValue);
+        text.setPosition(countdown, centre, 108.0f);
+        text.setVisible(countdown, counting);
+        return text.draw(windowWidth, windowHeight);
+    }
+};
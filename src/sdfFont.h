@@ -0,0 +1,150 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+// ImGui compiles its own private copy of stb_truetype, this is ours
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "imstb_truetype.h"
+
+// one corner of a text quad, in window pixels with y down
+struct sdfVertex {
+    float x, y;
+    float u, v;
+    uint32_t color; // RGBA, red in the low byte like IM_COL32
+};
+
+struct sdfGlyph {
+    float u0 = 0, v0 = 0, u1 = 0, v1 = 0; // where it is in the atlas
+    float left = 0, top = 0;              // quad corner relative to the pen on the baseline, at baseSize
+    float width = 0, height = 0;
+    float advance = 0;
+};
+
+// Printable ASCII from a TTF as one signed distance field atlas. The field is rendered once at baseSize and
+// stays sharp when drawn much larger or smaller, so one atlas serves every text size. No GL in here, see sdfText.
+class sdfFont {
+public:
+    static const int firstChar = 32;
+    static const int charCount = 95;
+    static const int baseSize = 64;    // pixel height the distance field is rendered at
+    static const int padding = 8;      // how far outside the outline the field reaches, in base pixels
+    static const int atlasWidth = 1024;
+
+    sdfGlyph glyphs[charCount];
+    std::vector<unsigned char> atlas;  // one byte per texel, 128 on the outline
+    int atlasHeight = 0;
+    float ascent = 0.0f;               // base pixels from the top of a line to the baseline
+
+    bool loadFile(const char* path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+            return false;
+        std::vector<unsigned char> ttf((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        return load(ttf.data());
+    }
+
+    bool load(const unsigned char* ttf) {
+        stbtt_fontinfo info;
+        if (!stbtt_InitFont(&info, ttf, stbtt_GetFontOffsetForIndex(ttf, 0)))
+            return false;
+
+        // same scale ImGui uses, so 120 here is as big as a 120 px ImGui font
+        float scale = stbtt_ScaleForPixelHeight(&info, static_cast<float>(baseSize));
+        int fontAscent = 0, fontDescent = 0, lineGap = 0;
+        stbtt_GetFontVMetrics(&info, &fontAscent, &fontDescent, &lineGap);
+        ascent = fontAscent * scale;
+
+        struct bitmap { unsigned char* pixels; int width, height, x, y; };
+        bitmap bitmaps[charCount] = {};
+
+        // shelf packing: left to right, a new row when one is full
+        int penX = 0, penY = 0, rowHeight = 0;
+        for (int i = 0; i < charCount; i++) {
+            int codepoint = firstChar + i;
+            int advance = 0, leftBearing = 0;
+            stbtt_GetCodepointHMetrics(&info, codepoint, &advance, &leftBearing);
+            glyphs[i].advance = advance * scale;
+
+            bitmap& b = bitmaps[i];
+            int xoff = 0, yoff = 0;
+            b.pixels = stbtt_GetCodepointSDF(&info, scale, codepoint, padding, 128, 128.0f / padding, &b.width, &b.height, &xoff, &yoff);
+            if (b.pixels == nullptr)
+                continue; // space and friends have nothing to draw
+
+            if (penX + b.width + 1 > atlasWidth) {
+                penX = 0;
+                penY += rowHeight + 1;
+                rowHeight = 0;
+            }
+            b.x = penX;
+            b.y = penY;
+            penX += b.width + 1;
+            rowHeight = b.height > rowHeight ? b.height : rowHeight;
+
+            glyphs[i].left = static_cast<float>(xoff);
+            glyphs[i].top = static_cast<float>(yoff);
+            glyphs[i].width = static_cast<float>(b.width);
+            glyphs[i].height = static_cast<float>(b.height);
+        }
+        atlasHeight = penY + rowHeight;
+
+        atlas.assign(static_cast<size_t>(atlasWidth) * atlasHeight, 0);
+        for (int i = 0; i < charCount; i++) {
+            bitmap& b = bitmaps[i];
+            if (b.pixels == nullptr)
+                continue;
+            for (int row = 0; row < b.height; row++)
+                std::copy(b.pixels + row * b.width, b.pixels + (row + 1) * b.width, &atlas[static_cast<size_t>(b.y + row) * atlasWidth + b.x]);
+            glyphs[i].u0 = static_cast<float>(b.x) / atlasWidth;
+            glyphs[i].v0 = static_cast<float>(b.y) / atlasHeight;
+            glyphs[i].u1 = static_cast<float>(b.x + b.width) / atlasWidth;
+            glyphs[i].v1 = static_cast<float>(b.y + b.height) / atlasHeight;
+            stbtt_FreeSDF(b.pixels, nullptr);
+        }
+        return atlasHeight > 0;
+    }
+
+    const sdfGlyph* glyph(char c) const {
+        int index = static_cast<unsigned char>(c) - firstChar;
+        return index >= 0 && index < charCount ? &glyphs[index] : nullptr;
+    }
+
+    float textWidth(const char* text, float pixelSize) const {
+        float width = 0.0f;
+        for (const char* c = text; *c != '\0'; c++) {
+            const sdfGlyph* g = glyph(*c);
+            width += g != nullptr ? g->advance : 0.0f;
+        }
+        return width * pixelSize / baseSize;
+    }
+
+    // Two triangles per visible character into out (room for maxVertices), with the top left of the line at x, y.
+    // Returns how many vertices were written.
+    int layout(const char* text, float x, float y, float pixelSize, uint32_t color, sdfVertex* out, int maxVertices) const {
+        float s = pixelSize / baseSize;
+        float penX = x;
+        float baseline = y + ascent * s;
+        int count = 0;
+        for (const char* c = text; *c != '\0'; c++) {
+            const sdfGlyph* g = glyph(*c);
+            if (g == nullptr)
+                continue;
+            if (g->width > 0.0f && count + 6 <= maxVertices) {
+                float x0 = penX + g->left * s, y0 = baseline + g->top * s;
+                float x1 = x0 + g->width * s, y1 = y0 + g->height * s;
+                out[count++] = { x0, y0, g->u0, g->v0, color };
+                out[count++] = { x1, y0, g->u1, g->v0, color };
+                out[count++] = { x1, y1, g->u1, g->v1, color };
+                out[count++] = { x0, y0, g->u0, g->v0, color };
+                out[count++] = { x1, y1, g->u1, g->v1, color };
+                out[count++] = { x0, y1, g->u0, g->v1, color };
+            }
+            penX += g->advance * s;
+        }
+        return count;
+    }
+};
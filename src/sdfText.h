@@ -0,0 +1,246 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <glad/glad.h>
+#include "sdfFont.h"
+
+// A handful of labels drawn from an sdfFont in one draw call. Labels keep their laid-out quads and the vertex
+// buffer is only rewritten when a label's text, position or visibility actually changes, so an unchanged HUD
+// costs a few compares and a glDrawArrays. Nothing is allocated after init.
+class sdfText {
+public:
+    static const int maxLabels = 8;
+    static const int maxLabelLength = 15;
+    static const int maxVertices = maxLabels * maxLabelLength * 6;
+
+    struct label {
+        char text[maxLabelLength + 1] = {};
+        float x = 0.0f, y = 0.0f;
+        float size = 32.0f;
+        float anchorX = 0.0f;    // 0 = x is the left edge, 0.5 = the centre, 1 = the right edge
+        uint32_t color = 0xFFFFFFFF;
+        bool visible = true;
+    };
+
+    bool enabled = false;
+    sdfFont font;
+    label labels[maxLabels];
+    int labelCount = 0;
+    bool dirty = true;
+
+    std::vector<sdfVertex> vertices; // sized once, maxVertices
+    int vertexCount = 0;
+
+    GLuint texture = 0;
+    GLuint vao = 0;
+    GLuint vbo = 0;
+    GLuint program = 0;
+    GLint screenSizeLocation = -1;
+
+    // builds the distance field atlas, no GL so it can run off the GL thread
+    bool loadFont(const unsigned char* ttf) {
+        if (ttf == nullptr || !font.load(ttf)) {
+            std::cout << "Couldn't load the HUD font" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // the GL side, after loadFont
+    bool init() {
+        if (font.atlasHeight == 0 || !createProgram())
+            return false;
+
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, sdfFont::atlasWidth, font.atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, font.atlas.data());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+
+        vertices.resize(maxVertices);
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(sdfVertex) * maxVertices, nullptr, GL_DYNAMIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(sdfVertex), (void*)offsetof(sdfVertex, x));
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(sdfVertex), (void*)offsetof(sdfVertex, u));
+        glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(sdfVertex), (void*)offsetof(sdfVertex, color));
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glEnableVertexAttribArray(2);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        enabled = true;
+        return true;
+    }
+
+    void shutdown() {
+        if (!enabled)
+            return;
+        glDeleteTextures(1, &texture);
+        glDeleteBuffers(1, &vbo);
+        glDeleteVertexArrays(1, &vao);
+        glDeleteProgram(program);
+        enabled = false;
+    }
+
+    // returns the label's index, or -1 when there is no room
+    int addLabel(float size, uint32_t color, float anchorX) {
+        if (labelCount == maxLabels)
+            return -1;
+        label& l = labels[labelCount];
+        l.size = size;
+        l.color = color;
+        l.anchorX = anchorX;
+        dirty = true;
+        return labelCount++;
+    }
+
+    void setText(int index, const char* text) {
+        if (index < 0 || strncmp(labels[index].text, text, maxLabelLength) == 0)
+            return;
+        strncpy(labels[index].text, text, maxLabelLength);
+        labels[index].text[maxLabelLength] = '\0';
+        dirty = true;
+    }
+
+    void setNumber(int index, int value) {
+        char text[16];
+        snprintf(text, sizeof(text), "%d", value);
+        setText(index, text);
+    }
+
+    void setPosition(int index, float x, float y) {
+        if (index < 0 || (labels[index].x == x && labels[index].y == y))
+            return;
+        labels[index].x = x;
+        labels[index].y = y;
+        dirty = true;
+    }
+
+    void setVisible(int index, bool visible) {
+        if (index < 0 || labels[index].visible == visible)
+            return;
+        labels[index].visible = visible;
+        dirty = true;
+    }
+
+    void rebuild() {
+        vertexCount = 0;
+        for (int i = 0; i < labelCount; i++) {
+            const label& l = labels[i];
+            if (!l.visible || l.text[0] == '\0')
+                continue;
+            float left = l.x - font.textWidth(l.text, l.size) * l.anchorX;
+            vertexCount += font.layout(l.text, left, l.y, l.size, l.color, &vertices[vertexCount], maxVertices - vertexCount);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(sdfVertex) * vertexCount, vertices.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        dirty = false;
+    }
+
+    // draws every visible label over whatever is in the framebuffer. Returns the triangles drawn.
+    int draw(float screenWidth, float screenHeight) {
+        if (!enabled)
+            return 0;
+        if (dirty)
+            rebuild();
+        if (vertexCount == 0)
+            return 0;
+
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glUseProgram(program);
+        glUniform2f(screenSizeLocation, screenWidth, screenHeight);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glBindVertexArray(vao);
+        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+        glBindVertexArray(0);
+        glDisable(GL_BLEND);
+        glEnable(GL_DEPTH_TEST);
+        return vertexCount / 3;
+    }
+
+    static bool compile(GLuint shader, const char* source) {
+        glShaderSource(shader, 1, &source, NULL);
+        glCompileShader(shader);
+        int success = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            char infoLog[512];
+            glGetShaderInfoLog(shader, 512, NULL, infoLog);
+            std::cout << "ERROR::SHADER::SDF_TEXT::COMPILATION_FAILED\n" << infoLog << std::endl;
+        }
+        return success != 0;
+    }
+
+    bool createProgram() {
+        const char* vertexSource =
+            "#version 450 core\n"
+            "layout (location = 0) in vec2 aPos;\n"
+            "layout (location = 1) in vec2 aUv;\n"
+            "layout (location = 2) in vec4 aColor;\n"
+            "uniform vec2 screenSize;\n"
+            "out vec2 uv;\n"
+            "out vec4 color;\n"
+            "void main()\n"
+            "{\n"
+            "    uv = aUv;\n"
+            "    color = aColor;\n"
+            "    gl_Position = vec4(aPos.x / screenSize.x * 2.0 - 1.0, 1.0 - aPos.y / screenSize.y * 2.0, 0.0, 1.0);\n"
+            "}";
+
+        // 0.5 in the field is the outline; fwidth keeps the edge about one screen pixel wide at any size
+        const char* fragmentSource =
+            "#version 450 core\n"
+            "in vec2 uv;\n"
+            "in vec4 color;\n"
+            "out vec4 FragColor;\n"
+            "uniform sampler2D field;\n"
+            "void main()\n"
+            "{\n"
+            "    float distance = texture(field, uv).r;\n"
+            "    float edge = max(fwidth(distance) * 0.5, 1.0 / 255.0);\n"
+            "    float coverage = smoothstep(0.5 - edge, 0.5 + edge, distance);\n"
+            "    FragColor = vec4(color.rgb, color.a * coverage);\n"
+            "}";
+
+        GLuint vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        GLuint fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        bool compiled = compile(vertexShader, vertexSource) && compile(fragmentShader, fragmentSource);
+
+        program = glCreateProgram();
+        glAttachShader(program, vertexShader);
+        glAttachShader(program, fragmentShader);
+        glLinkProgram(program);
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+
+        int linked = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!compiled || !linked) {
+            std::cout << "Couldn't build the SDF text shader" << std::endl;
+            return false;
+        }
+
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "field"), 0);
+        screenSizeLocation = glGetUniformLocation(program, "screenSize");
+        glUseProgram(0);
+        return true;
+    }
+};
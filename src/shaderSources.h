@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdarg>
+#include <cstdio>
+#include <string>
+
+// GLSL for the cubes and rectangles, kept apart from basicGraphicalThings so it can be benchmarked without a GL context.
+// Each source is one string built in one allocation, the colours go in with %g (what a stream would have written).
+
+inline std::string formatShaderSource(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    va_list measure;
+    va_copy(measure, args);
+    int length = vsnprintf(nullptr, 0, format, measure);
+    va_end(measure);
+    std::string source(static_cast<size_t>(length > 0 ? length : 0), '\0');
+    vsnprintf(&source[0], source.size() + 1, format, args);
+    va_end(args);
+    return source;
+}
+
+inline std::string buildVertexShaderSource(bool ThreeDs) {
+    if (ThreeDs) {
+        // instanced: each copy is moved alpha of the way from its previous position and scaled, cubeModelMatrix's maths
+        return "#version 450 core\n"
+            "layout (location = 0) in vec3 aPos;\n"
+            "layout (location = 1) in vec3 previousPosition;\n"
+            "layout (location = 2) in vec3 position;\n"
+            "layout (location = 3) in vec3 scale;\n"
+            "\n"
+            "uniform mat4 projection;\n"
+            "uniform mat4 view;\n"
+            "uniform float alpha;\n"
+            "\n"
+            "out vec3 objectPosition;\n"
+            "\n"
+            "void main()\n"
+            "{\n"
+            "    objectPosition = aPos;\n"
+            "    vec3 world = mix(previousPosition, position, alpha) + aPos * scale;\n"
+            "    gl_Position = projection * view * vec4(world, 1.0);\n"
+            "}";
+    }
+    return "#version 450 core\n"
+        "layout (location = 0) in vec3 aPos;\n"
+        "void main()\n"
+        "{\n"
+        "    gl_Position = vec4(aPos.x, aPos.y, aPos.z, 1.0);"
+        "}";
+}
+
+inline std::string buildFragmentShaderSource(float r, float g, float b, float a) {
+    return formatShaderSource("#version 450 core\n"
+        "out vec4 FragColor;\n"
+        "void main()\n"
+        "{\n"
+        "    FragColor = vec4(%g, %g, %g, %g); "
+        "}\n", r, g, b, a);
+}
+
+// The 3D colour times a skin from texture unit 0. The meshes have no texture coordinates, so the skin is box
+// projected: each face takes the two object space axes it isn't facing, which puts one copy of the skin on every
+// side of the unit cube. Bound to a white texel it's exactly buildFragmentShaderSource's colour.
+inline std::string buildTexturedFragmentShaderSource(float r, float g, float b, float a) {
+    return formatShaderSource("#version 450 core\n"
+        "in vec3 objectPosition;\n"
+        "out vec4 FragColor;\n"
+        "uniform sampler2D skin;\n"
+        "void main()\n"
+        "{\n"
+        "    vec3 facing = abs(cross(dFdx(objectPosition), dFdy(objectPosition)));\n"
+        "    vec2 uv = facing.x > facing.y && facing.x > facing.z ? objectPosition.zy\n"
+        "        : facing.y > facing.z ? objectPosition.xz : objectPosition.xy;\n"
+        "    FragColor = vec4(%g, %g, %g, %g) * texture(skin, uv + 0.5);\n"
+        "}\n", r, g, b, a);
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <vector>
+
+class verticesAndIndicesForShapes {
+public:
+    void PositionsForRectangle(std::vector<float>& vertices, std::vector<unsigned int>& indices, float x, float y, float width, float height) {
+        float halfWidth = width / 2;
+        float halfHeight = height / 2;
+        vertices.assign({
+            x + halfWidth,  y + halfHeight, 0.0f,  // top right
+            x + halfWidth, y - halfHeight, 0.0f,   // bottom right
+            x - halfWidth, y - halfHeight, 0.0f,   // bottom left
+            x - halfWidth,  y + halfHeight, 0.0f   // top left 
+        });
+
+        indices.assign({
+            0, 1, 3,
+            1, 2, 3
+        });
+    }
+
+    void PositionsForCube(std::vector<float>& vertices, std::vector<unsigned int>& indices, float x, float y, float z, float width, float height, float depth) {
+        float halfWidth = width / 2;
+        float halfHeight = height / 2;
+        float halfDepth = depth / 2;
+        vertices.assign({
+            x + halfWidth,  y + halfHeight, z - halfDepth,
+            x + halfWidth, y - halfHeight, z - halfDepth,
+            x - halfWidth, y - halfHeight, z - halfDepth,
+            x - halfWidth,  y + halfHeight, z - halfDepth,
+
+            x + halfWidth,  y + halfHeight, z + halfDepth,
+            x + halfWidth, y - halfHeight, z + halfDepth,
+            x - halfWidth, y - halfHeight, z + halfDepth,
+            x - halfWidth,  y + halfHeight, z + halfDepth
+            });
+
+        indices.assign({
+            // Front face (z+)
+            4, 5, 6,
+            4, 6, 7,
+
+            // Back face (z-)
+            0, 3, 2,
+            0, 2, 1,
+
+            // Left face (x-)
+            3, 7, 6,
+            3, 6, 2,
+
+            // Right face (x+)
+            0, 1, 5,
+            0, 5, 4,
+
+            // Top face (y+)
+            0, 4, 7,
+            0, 7, 3,
+
+            // Bottom face (y-)
+            1, 2, 6,
+            1, 6, 5
+            });
+    }
+};
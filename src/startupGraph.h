@@ -0,0 +1,292 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <initializer_list>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gameClock.h"
+#include "profiler.h"
+
+// Where a startup task runs. Main tasks run on the GL thread in the order they were added, deferred ones also run
+// there but only once the caller asks for them (the start screen doesn't need the arena), and worker tasks run on
+// startup threads as soon as their dependencies are done.
+enum startupQueue { startupWorker, startupMain, startupDeferred };
+
+// Startup as a graph of tasks rather than one long init(): CPU-only work (audio device, sound decoding, font
+// rasterizing, shader sources) overlaps the GL thread creating the window and context, and every task is timed so
+// the report shows what the first frame is waiting on.
+//
+//     int font = startup.add("font file", startupWorker, [] { return fonts.loadFile(path); });
+//     startup.add("font texture", startupMain, [] { ... return true; }, { font });
+//     if (!startup.run())          // starts the workers, runs the main tasks
+//         return -1;
+//     ...
+//     startup.runNextDeferred();   // a task per frame once the start screen is up
+//
+// A task returning false stops startup: everything that depends on it is skipped and run()/runNextDeferred()
+// return false. Dependencies have to be added first, so the graph can't have cycles.
+class startupGraph {
+public:
+    enum taskState { taskPending, taskRunning, taskDone, taskFailed, taskSkipped };
+
+    struct task {
+        const char* name;
+        startupQueue queue;
+        std::function<bool()> work;
+        std::vector<int> dependsOn;
+        taskState state;
+        int thread;       // 0 = the GL thread, workers count from 1
+        uint64_t start;
+        uint64_t end;
+        uint64_t waited;  // GL thread time spent waiting on dependencies before starting
+        bool critical;    // a main task needs it, so the first frame does: workers take these first
+    };
+
+    std::vector<task> tasks;
+    uint64_t created = nowNanoseconds(); // report times are relative to this, so make the graph first thing in main
+    uint64_t mainDone = 0;
+    bool failed = false;
+    bool finished = false; // every task has run and the workers are gone
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::thread> workers;
+
+    ~startupGraph() {
+        join();
+    }
+
+    int add(const char* name, startupQueue queue, std::function<bool()> work, std::initializer_list<int> dependsOn = {}) {
+        int index = static_cast<int>(tasks.size());
+        std::vector<int> dependencies;
+        for (int dependency : dependsOn) {
+            if (dependency >= 0 && dependency < index)
+                dependencies.push_back(dependency);
+            else
+                std::cout << "Startup task " << name << " depends on one that isn't added yet, ignoring it" << std::endl;
+        }
+        tasks.push_back({ name, queue, std::move(work), std::move(dependencies), taskPending, 0, 0, 0, 0, false });
+        return index;
+    }
+
+    // starts the workers and runs every main task. False if a task failed.
+    bool run() {
+        // dependencies always come first, so one pass backwards marks everything the main tasks need
+        for (size_t i = tasks.size(); i-- > 0;)
+            if (tasks[i].queue == startupMain || tasks[i].critical)
+                for (int dependency : tasks[i].dependsOn)
+                    tasks[dependency].critical = true;
+
+        int workerTasks = static_cast<int>(std::count_if(tasks.begin(), tasks.end(), [](const task& t) { return t.queue == startupWorker; }));
+        int spareThreads = static_cast<int>(std::thread::hardware_concurrency()) - 1; // the GL thread is busy too
+        int workerCount = spareThreads > 1 ? spareThreads : 1;
+        if (workerCount > workerTasks)
+            workerCount = workerTasks;
+        for (int i = 0; i < workerCount; i++)
+            workers.emplace_back([this, i] { workerLoop(i + 1); });
+
+        std::unique_lock<std::mutex> lock(mutex);
+        for (size_t i = 0; i < tasks.size() && !failed; i++)
+            if (tasks[i].queue == startupMain)
+                runOnThisThread(static_cast<int>(i), lock);
+        mainDone = nowNanoseconds();
+        if (failed)
+            abandon();
+        return !failed;
+    }
+
+    // runs the next deferred task, or once there are none left waits for the workers. False if a task failed.
+    bool runNextDeferred() {
+        if (finished)
+            return !failed;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            for (size_t i = 0; i < tasks.size() && !failed; i++) {
+                if (tasks[i].queue == startupDeferred && tasks[i].state == taskPending) {
+                    runOnThisThread(static_cast<int>(i), lock);
+                    return !failed;
+                }
+            }
+        }
+        join();
+        return !failed;
+    }
+
+    // everything left, for when the game needs it right now
+    bool runDeferred() {
+        while (!finished)
+            runNextDeferred();
+        return !failed;
+    }
+
+    // skips whatever hasn't started and waits for the workers, safe to call any time
+    void join() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            abandon();
+        }
+        for (std::thread& worker : workers)
+            worker.join();
+        workers.clear();
+        finished = true;
+    }
+
+    // per task timings to the console, and to a CSV when there's a path. firstFrame is when the first frame was
+    // swapped, 0 if it hasn't been.
+    void report(uint64_t firstFrame, const std::string& csvPath) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<const task*> order;
+        for (const task& t : tasks)
+            order.push_back(&t);
+        std::stable_sort(order.begin(), order.end(), [](const task* a, const task* b) { return sortTime(*a) < sortTime(*b); });
+
+        std::cout << std::fixed << std::setprecision(2)
+            << "Startup: GL thread ready after " << milliseconds(mainDone) << " ms";
+        if (firstFrame != 0)
+            std::cout << ", first frame at " << milliseconds(firstFrame) << " ms";
+        std::cout << std::endl;
+        std::cout << "  " << std::left << std::setw(24) << "task" << std::setw(10) << "thread" << std::right
+            << std::setw(10) << "start" << std::setw(10) << "took" << std::setw(10) << "waited" << std::endl;
+        for (const task* t : order) {
+            std::cout << "  " << std::left << std::setw(24) << t->name << std::setw(10) << threadName(*t) << std::right;
+            if (ran(*t))
+                std::cout << std::setw(10) << milliseconds(t->start) << std::setw(10) << (t->end - t->start) / 1.0e6
+                    << std::setw(10) << t->waited / 1.0e6 << (t->state == taskFailed ? "  failed" : "");
+            else
+                std::cout << "  skipped";
+            std::cout << std::endl;
+        }
+        std::cout << std::defaultfloat << std::setprecision(6);
+
+        if (csvPath.empty())
+            return;
+        std::ofstream out(csvPath);
+        if (!out) {
+            std::cout << "Couldn't write " << csvPath << std::endl;
+            return;
+        }
+        out << "task,queue,thread,start_ms,duration_ms,waited_ms,state\n";
+        for (const task* t : order) {
+            const char* queues[] = { "worker", "main", "deferred" };
+            const char* states[] = { "pending", "running", "done", "failed", "skipped" };
+            out << t->name << ',' << queues[t->queue] << ',' << t->thread << ','
+                << (ran(*t) ? milliseconds(t->start) : 0.0) << ',' << (ran(*t) ? (t->end - t->start) / 1.0e6 : 0.0) << ','
+                << t->waited / 1.0e6 << ',' << states[t->state] << '\n';
+        }
+        out << "first_frame,main,0," << (firstFrame != 0 ? milliseconds(firstFrame) : 0.0) << ",0,0,"
+            << (firstFrame != 0 ? "done" : "pending") << '\n';
+    }
+
+private:
+    double milliseconds(uint64_t time) const {
+        return time > created ? (time - created) / 1.0e6 : 0.0;
+    }
+
+    static bool ran(const task& t) {
+        return t.state == taskDone || t.state == taskFailed;
+    }
+
+    // in the order they started, the ones that never did last
+    static uint64_t sortTime(const task& t) {
+        return ran(t) ? t.start : UINT64_MAX;
+    }
+
+    static std::string threadName(const task& t) {
+        if (!ran(t))
+            return "-";
+        return t.thread == 0 ? "main" : "worker " + std::to_string(t.thread);
+    }
+
+    // taskDone when every dependency is, taskFailed when one failed or was skipped, otherwise taskPending
+    taskState dependencies(const task& t) const {
+        taskState result = taskDone;
+        for (int dependency : t.dependsOn) {
+            taskState state = tasks[dependency].state;
+            if (state == taskFailed || state == taskSkipped)
+                return taskFailed;
+            if (state != taskDone)
+                result = taskPending;
+        }
+        return result;
+    }
+
+    // the mutex is held on entry and exit, not while the task runs
+    void execute(int index, int thread, std::unique_lock<std::mutex>& lock) {
+        task& t = tasks[index];
+        t.state = taskRunning;
+        t.thread = thread;
+        t.start = nowNanoseconds();
+        lock.unlock();
+        bool succeeded = false;
+        {
+            PROFILE_ZONE(t.name);
+            succeeded = t.work();
+        }
+        lock.lock();
+        t.end = nowNanoseconds();
+        t.state = succeeded ? taskDone : taskFailed;
+        if (!succeeded) {
+            failed = true;
+            std::cout << "Startup task " << t.name << " failed" << std::endl;
+        }
+        changed.notify_all();
+    }
+
+    void runOnThisThread(int index, std::unique_lock<std::mutex>& lock) {
+        task& t = tasks[index];
+        uint64_t waitStart = nowNanoseconds();
+        taskState ready;
+        while ((ready = dependencies(t)) == taskPending)
+            changed.wait(lock);
+        t.waited = nowNanoseconds() - waitStart;
+        if (ready == taskFailed) {
+            t.state = taskSkipped;
+            failed = true;
+            changed.notify_all();
+            return;
+        }
+        execute(index, 0, lock);
+    }
+
+    void workerLoop(int thread) {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            bool remaining = false;
+            int next = -1;
+            for (size_t i = 0; i < tasks.size(); i++) {
+                task& t = tasks[i];
+                if (t.queue != startupWorker || t.state != taskPending)
+                    continue;
+                taskState ready = dependencies(t);
+                if (ready == taskFailed) {
+                    t.state = taskSkipped;
+                    changed.notify_all();
+                    continue;
+                }
+                remaining = true;
+                if (ready == taskDone && (next == -1 || (t.critical && !tasks[next].critical)))
+                    next = static_cast<int>(i);
+            }
+            if (!remaining)
+                return;
+            if (next == -1)
+                changed.wait(lock);
+            else
+                execute(next, thread, lock);
+        }
+    }
+
+    // nothing pending on the GL thread will run now, so workers waiting on it give up instead of waiting forever
+    void abandon() {
+        for (task& t : tasks)
+            if (t.queue != startupWorker && t.state == taskPending)
+                t.state = taskSkipped;
+        changed.notify_all();
+    }
+};
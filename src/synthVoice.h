@@ -0,0 +1,318 @@
+#pragma once
+#include <cmath>
+#include "miniaudio.h"
+
+// A single note of a synth patch: an oscillator shaped by an ADSR envelope.
+struct synthNote {
+    ma_waveform_type type = ma_waveform_type_square;
+    double startFrequency = 440.0;
+    double endFrequency = 440.0;   // frequency is swept linearly across the note
+    float startTime = 0.0f;        // seconds from the start of the patch
+    float attack = 0.005f;
+    float decay = 0.05f;
+    float sustainLevel = 0.6f;
+    float sustainTime = 0.05f;
+    float release = 0.05f;
+    float amplitude = 0.3f;
+
+    float length() const {
+        return attack + decay + sustainTime + release;
+    }
+
+    // t is seconds since the note started
+    float envelope(float t) const {
+        if (t < attack)
+            return t / attack;
+        t -= attack;
+        if (t < decay)
+            return 1.0f - (1.0f - sustainLevel) * (t / decay);
+        t -= decay;
+        if (t < sustainTime)
+            return sustainLevel;
+        t -= sustainTime;
+        if (t < release)
+            return sustainLevel * (1.0f - t / release);
+        return 0.0f;
+    }
+};
+
+// Up to four notes played one after the other, enough for every sound in the game.
+struct synthPatch {
+    static const int maxNotes = 4;
+    synthNote notes[maxNotes];
+    int noteCount = 0;
+
+    float length() const {
+        float end = 0.0f;
+        for (int i = 0; i < noteCount; i++)
+            end = fmaxf(end, notes[i].startTime + notes[i].length());
+        return end;
+    }
+
+    void addNote(const synthNote& note) {
+        if (noteCount < maxNotes)
+            notes[noteCount++] = note;
+    }
+
+    static synthPatch dink() {
+        synthPatch patch;
+        synthNote note;
+        note.type = ma_waveform_type_triangle;
+        note.startFrequency = note.endFrequency = 1320.0;
+        note.attack = 0.002f;
+        note.decay = 0.08f;
+        note.sustainLevel = 0.0f;
+        note.sustainTime = 0.0f;
+        note.release = 0.0f;
+        note.amplitude = 0.5f;
+        patch.addNote(note);
+        return patch;
+    }
+
+    static synthPatch point() {
+        synthPatch patch;
+        synthNote note;
+        note.startFrequency = 440.0;
+        note.endFrequency = 880.0;
+        note.decay = 0.1f;
+        note.sustainTime = 0.15f;
+        note.release = 0.1f;
+        patch.addNote(note);
+        return patch;
+    }
+
+    // three short beeps a second apart and a long high one when the ball is served
+    static synthPatch countdown() {
+        synthPatch patch;
+        synthNote note;
+        note.startFrequency = note.endFrequency = 440.0;
+        note.sustainTime = 0.1f;
+        for (int i = 0; i < 3; i++) {
+            note.startTime = static_cast<float>(i);
+            patch.addNote(note);
+        }
+        note.startFrequency = note.endFrequency = 880.0;
+        note.startTime = 3.0f;
+        note.sustainTime = 0.3f;
+        note.release = 0.15f;
+        patch.addNote(note);
+        return patch;
+    }
+
+    static synthPatch win() {
+        synthPatch patch;
+        const double arpeggio[maxNotes] = { 523.25, 659.25, 783.99, 1046.5 }; // C5 E5 G5 C6
+        synthNote note;
+        note.sustainTime = 0.1f;
+        for (int i = 0; i < maxNotes; i++) {
+            note.startFrequency = note.endFrequency = arpeggio[i];
+            note.startTime = 0.15f * i;
+            if (i == maxNotes - 1) {
+                note.sustainTime = 0.5f;
+                note.release = 0.3f;
+            }
+            patch.addNote(note);
+        }
+        return patch;
+    }
+};
+
+// A miniaudio data source that renders a synthPatch on the fly, so no file I/O or decoding is needed.
+class synthVoice {
+public:
+    ma_data_source_base base; // must stay the first member, miniaudio treats the voice as a ma_data_source_base
+    ma_waveform oscillator;
+    synthPatch patch;
+    ma_uint32 sampleRate = 48000;
+    ma_uint64 cursor = 0;
+    ma_uint64 lengthInFrames = 0;
+    int currentNote = -1;
+
+    ma_result init(ma_uint32 sampleRate) {
+        static ma_data_source_vtable vtable = {
+            onRead, onSeek, onGetDataFormat, onGetCursor, onGetLength, NULL, 0
+        };
+
+        this->sampleRate = sampleRate;
+
+        ma_data_source_config config = ma_data_source_config_init();
+        config.vtable = &vtable;
+        ma_result result = ma_data_source_init(&config, &base);
+        if (result != MA_SUCCESS)
+            return result;
+
+        ma_waveform_config oscillatorConfig = ma_waveform_config_init(ma_format_f32, 1, sampleRate, ma_waveform_type_square, 1.0, 440.0);
+        return ma_waveform_init(&oscillatorConfig, &oscillator);
+    }
+
+    void uninit() {
+        ma_waveform_uninit(&oscillator);
+        ma_data_source_uninit(&base);
+    }
+
+    // only call this while the voice isn't playing
+    void setPatch(const synthPatch& patch) {
+        this->patch = patch;
+        lengthInFrames = static_cast<ma_uint64>(patch.length() * sampleRate);
+        cursor = 0;
+        currentNote = -1;
+    }
+
+private:
+    ma_uint64 secondsToFrames(float seconds) const {
+        return static_cast<ma_uint64>(seconds * sampleRate);
+    }
+
+    int noteAt(ma_uint64 frame) const {
+        for (int i = 0; i < patch.noteCount; i++) {
+            ma_uint64 start = secondsToFrames(patch.notes[i].startTime);
+            ma_uint64 end = start + secondsToFrames(patch.notes[i].length());
+            if (frame >= start && frame < end)
+                return i;
+        }
+        return -1;
+    }
+
+    // first note start or end after frame, so a block never spans two notes
+    ma_uint64 nextBoundary(ma_uint64 frame) const {
+        ma_uint64 boundary = lengthInFrames;
+        for (int i = 0; i < patch.noteCount; i++) {
+            ma_uint64 start = secondsToFrames(patch.notes[i].startTime);
+            ma_uint64 end = start + secondsToFrames(patch.notes[i].length());
+            if (start > frame && start < boundary)
+                boundary = start;
+            if (end > frame && end < boundary)
+                boundary = end;
+        }
+        return boundary;
+    }
+
+    void render(float* out, ma_uint64 frameCount) {
+        const ma_uint64 blockSize = 64; // the sweep frequency is updated once per block
+
+        while (frameCount > 0) {
+            ma_uint64 block = frameCount < blockSize ? frameCount : blockSize;
+            ma_uint64 boundary = nextBoundary(cursor);
+            if (cursor + block > boundary)
+                block = boundary - cursor;
+
+            int note = noteAt(cursor);
+            if (note < 0) {
+                for (ma_uint64 i = 0; i < block; i++)
+                    out[i] = 0.0f;
+            }
+            else {
+                const synthNote& n = patch.notes[note];
+                float noteStart = n.startTime;
+
+                if (note != currentNote) {
+                    ma_waveform_set_type(&oscillator, n.type);
+                    ma_waveform_seek_to_pcm_frame(&oscillator, 0);
+                    currentNote = note;
+                }
+
+                float t = static_cast<float>(cursor) / sampleRate - noteStart;
+                double progress = t / n.length();
+                ma_waveform_set_frequency(&oscillator, n.startFrequency + (n.endFrequency - n.startFrequency) * progress);
+                ma_waveform_read_pcm_frames(&oscillator, out, block, NULL);
+
+                for (ma_uint64 i = 0; i < block; i++) {
+                    float frameTime = t + static_cast<float>(i) / sampleRate;
+                    out[i] *= n.amplitude * n.envelope(frameTime);
+                }
+            }
+
+            out += block;
+            cursor += block;
+            frameCount -= block;
+        }
+    }
+
+    static ma_result onRead(ma_data_source* pDataSource, void* pFramesOut, ma_uint64 frameCount, ma_uint64* pFramesRead) {
+        synthVoice* voice = static_cast<synthVoice*>(pDataSource);
+
+        ma_uint64 remaining = voice->lengthInFrames > voice->cursor ? voice->lengthInFrames - voice->cursor : 0;
+        ma_uint64 framesToRead = frameCount < remaining ? frameCount : remaining;
+
+        if (pFramesOut != NULL)
+            voice->render(static_cast<float*>(pFramesOut), framesToRead);
+        else
+            voice->cursor += framesToRead;
+
+        if (pFramesRead != NULL)
+            *pFramesRead = framesToRead;
+
+        return framesToRead == 0 ? MA_AT_END : MA_SUCCESS;
+    }
+
+    static ma_result onSeek(ma_data_source* pDataSource, ma_uint64 frameIndex) {
+        synthVoice* voice = static_cast<synthVoice*>(pDataSource);
+        voice->cursor = frameIndex;
+        voice->currentNote = -1;
+        return MA_SUCCESS;
+    }
+
+    static ma_result onGetDataFormat(ma_data_source* pDataSource, ma_format* pFormat, ma_uint32* pChannels, ma_uint32* pSampleRate, ma_channel* pChannelMap, size_t channelMapCap) {
+        synthVoice* voice = static_cast<synthVoice*>(pDataSource);
+        *pFormat = ma_format_f32;
+        *pChannels = 1;
+        *pSampleRate = voice->sampleRate;
+        ma_channel_map_init_standard(ma_standard_channel_map_default, pChannelMap, channelMapCap, 1);
+        return MA_SUCCESS;
+    }
+
+    static ma_result onGetCursor(ma_data_source* pDataSource, ma_uint64* pCursor) {
+        *pCursor = static_cast<synthVoice*>(pDataSource)->cursor;
+        return MA_SUCCESS;
+    }
+
+    static ma_result onGetLength(ma_data_source* pDataSource, ma_uint64* pLength) {
+        *pLength = static_cast<synthVoice*>(pDataSource)->lengthInFrames;
+        return MA_SUCCESS;
+    }
+};
+
+// A few voices so a dink can overlap the point sound. Everything lives in this object, nothing is loaded from disk.
+class synthSoundBank {
+public:
+    static const int voiceCount = 4;
+    synthVoice voices[voiceCount];
+    ma_sound sounds[voiceCount];
+    int initializedVoices = 0;
+
+    int init(ma_engine* engine) {
+        ma_uint32 sampleRate = ma_engine_get_sample_rate(engine);
+
+        for (int i = 0; i < voiceCount; i++) {
+            if (voices[i].init(sampleRate) != MA_SUCCESS)
+                return -1;
+            if (ma_sound_init_from_data_source(engine, &voices[i], MA_SOUND_FLAG_NO_SPATIALIZATION, NULL, &sounds[i]) != MA_SUCCESS) {
+                voices[i].uninit();
+                return -1;
+            }
+            initializedVoices++;
+        }
+
+        return 0;
+    }
+
+    void play(const synthPatch& patch) {
+        for (int i = 0; i < initializedVoices; i++) {
+            if (ma_sound_is_playing(&sounds[i]))
+                continue;
+
+            voices[i].setPatch(patch);
+            ma_sound_start(&sounds[i]);
+            return;
+        }
+        // every voice is busy, drop the sound rather than cut one off
+    }
+
+    void uninit() {
+        for (int i = 0; i < initializedVoices; i++) {
+            ma_sound_uninit(&sounds[i]);
+            voices[i].uninit();
+        }
+        initializedVoices = 0;
+    }
+};
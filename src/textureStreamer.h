@@ -0,0 +1,303 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glad/glad.h>
+#include "stb_image.h"
+#include "gameClock.h"
+#include "profiler.h"
+
+// Textures loaded without ever holding up a frame. Images are decoded with stb_image and their mip chain built on
+// decode threads; the GL thread then uploads them a slice at a time through a pixel unpack buffer, stopping once
+// update()'s time budget is spent, so a 4k skin just takes a few more frames. Until a texture is all there, bind()
+// binds a 1x1 white placeholder instead, which leaves the surface its plain colour.
+//
+//     int skin = textures.request("textures/floor.png");   // any time, decoding starts right away
+//     textures.update(1.0);                                 // once a frame on the GL thread, at most ~1 ms
+//     textures.bind(skin);                                  // texture unit 0, the placeholder until it's ready
+//
+// A file that isn't there just keeps the placeholder, skins are optional.
+class textureStreamer {
+public:
+    static const size_t sliceBytes = 256 * 1024; // per glTexSubImage2D, small enough to check the clock often
+
+    enum textureState { textureQueued, textureDecoded, textureReady, textureMissing, textureFailed };
+
+    struct mipLevel {
+        int width;
+        int height;
+        size_t offset; // into pixels
+    };
+
+    struct texture {
+        std::string path;
+        textureState state = textureQueued;
+        GLuint name = 0;
+        GLuint ready = 0;                  // name once it's all uploaded, only touched by the GL thread
+        std::vector<unsigned char> pixels; // RGBA8, every mip level back to back, freed after the upload
+        std::vector<mipLevel> levels;
+        int uploadLevel = 0;
+        int uploadRow = 0;
+        int uploadFrames = 0;
+        uint64_t requested = 0;
+        uint64_t decoded = 0;
+    };
+
+    std::deque<texture> textures; // a handle is an index, a deque so adding one doesn't move the others
+    std::deque<int> decodeQueue;
+    std::deque<int> uploadQueue;  // decoded, waiting for the GL thread
+    std::mutex mutex;
+    std::condition_variable queued;
+    std::vector<std::thread> decoders;
+    bool stopping = false;
+    std::atomic<int> pending{ 0 }; // requested but neither uploaded nor given up on yet
+
+    // GL thread only
+    bool glReady = false;
+    GLuint placeholder = 0;
+    GLuint unpackBuffer = 0;
+    GLuint bound = 0;
+    int uploading = -1;
+
+    // decoding can start before there's a GL context
+    void start(int threadCount) {
+        for (int i = 0; i < threadCount; i++)
+            decoders.emplace_back([this] { decodeLoop(); });
+    }
+
+    void initGL() {
+        const unsigned char white[4] = { 255, 255, 255, 255 };
+        glGenTextures(1, &placeholder);
+        glBindTexture(GL_TEXTURE_2D, placeholder);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glGenBuffers(1, &unpackBuffer);
+        glReady = true;
+    }
+
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        queued.notify_all();
+        for (std::thread& decoder : decoders)
+            decoder.join();
+        decoders.clear();
+
+        if (!glReady)
+            return;
+        for (texture& t : textures)
+            if (t.name != 0)
+                glDeleteTextures(1, &t.name);
+        glDeleteTextures(1, &placeholder);
+        glDeleteBuffers(1, &unpackBuffer);
+        glReady = false;
+    }
+
+    // returns a handle for bind(), the same one for a path that was already asked for. From the GL thread, like bind().
+    int request(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < textures.size(); i++)
+            if (textures[i].path == path)
+                return static_cast<int>(i);
+        textures.emplace_back();
+        textures.back().path = path;
+        textures.back().requested = nowNanoseconds();
+        int handle = static_cast<int>(textures.size()) - 1;
+        decodeQueue.push_back(handle);
+        pending++;
+        queued.notify_one();
+        return handle;
+    }
+
+    // -1 or anything not uploaded yet binds the placeholder. Skips the call when it's already bound.
+    void bind(int handle) {
+        GLuint name = placeholder;
+        if (handle >= 0 && textures[handle].ready != 0)
+            name = textures[handle].ready;
+        if (name == bound)
+            return;
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, name);
+        bound = name;
+    }
+
+    // Uploads decoded textures until the budget is spent, at least one slice a frame so something always moves.
+    // Call at the start of a frame: it also forgets what bind() last bound, since ImGui and the HUD bind their own.
+    void update(double budgetMilliseconds) {
+        PROFILE_ZONE("textureStreamer::update");
+        bound = 0;
+        if (!glReady)
+            return;
+        uint64_t deadline = nowNanoseconds() + static_cast<uint64_t>(budgetMilliseconds * 1.0e6);
+        bool uploadedThisFrame = false;
+        do {
+            if (uploading < 0) {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (uploadQueue.empty())
+                    break;
+                uploading = uploadQueue.front();
+                uploadQueue.pop_front();
+                createStorage(textures[uploading]);
+            }
+            texture& t = textures[uploading];
+            if (!uploadedThisFrame)
+                t.uploadFrames++;
+            uploadedThisFrame = true;
+            if (uploadSlice(t)) {
+                finish(t);
+                uploading = -1;
+            }
+        } while (nowNanoseconds() < deadline);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    // RGBA8 box filtered down to 1x1. Odd sizes repeat their last row or column rather than reading past it.
+    static void buildMips(std::vector<unsigned char>& pixels, std::vector<mipLevel>& levels, int width, int height) {
+        levels.clear();
+        size_t total = 0;
+        for (int w = width, h = height;; w = w > 1 ? w / 2 : 1, h = h > 1 ? h / 2 : 1) {
+            levels.push_back({ w, h, total });
+            total += static_cast<size_t>(w) * h * 4;
+            if (w == 1 && h == 1)
+                break;
+        }
+        pixels.resize(total);
+
+        for (size_t level = 1; level < levels.size(); level++) {
+            const mipLevel& source = levels[level - 1];
+            const mipLevel& target = levels[level];
+            const unsigned char* from = &pixels[source.offset];
+            unsigned char* to = &pixels[target.offset];
+            for (int y = 0; y < target.height; y++) {
+                int y0 = y * 2 < source.height ? y * 2 : source.height - 1;
+                int y1 = y * 2 + 1 < source.height ? y * 2 + 1 : source.height - 1;
+                for (int x = 0; x < target.width; x++) {
+                    int x0 = x * 2 < source.width ? x * 2 : source.width - 1;
+                    int x1 = x * 2 + 1 < source.width ? x * 2 + 1 : source.width - 1;
+                    for (int channel = 0; channel < 4; channel++) {
+                        int sum = from[(static_cast<size_t>(y0) * source.width + x0) * 4 + channel]
+                            + from[(static_cast<size_t>(y0) * source.width + x1) * 4 + channel]
+                            + from[(static_cast<size_t>(y1) * source.width + x0) * 4 + channel]
+                            + from[(static_cast<size_t>(y1) * source.width + x1) * 4 + channel];
+                        to[(static_cast<size_t>(y) * target.width + x) * 4 + channel] = static_cast<unsigned char>((sum + 2) / 4);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    void decodeLoop() {
+        for (;;) {
+            int handle = -1;
+            std::string path;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                queued.wait(lock, [this] { return stopping || !decodeQueue.empty(); });
+                if (stopping)
+                    return;
+                handle = decodeQueue.front();
+                decodeQueue.pop_front();
+                path = textures[handle].path;
+            }
+
+            PROFILE_ZONE("textureStreamer::decode");
+            std::vector<unsigned char> file;
+            std::ifstream in(path, std::ios::binary);
+            if (in)
+                file.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+            int width = 0, height = 0, channels = 0;
+            unsigned char* image = file.empty() ? nullptr
+                : stbi_load_from_memory(file.data(), static_cast<int>(file.size()), &width, &height, &channels, 4);
+            std::vector<unsigned char> pixels;
+            std::vector<mipLevel> levels;
+            if (image != nullptr) {
+                pixels.assign(image, image + static_cast<size_t>(width) * height * 4);
+                stbi_image_free(image);
+                buildMips(pixels, levels, width, height);
+            }
+            else if (!file.empty())
+                std::cout << "Couldn't decode " << path << ": " << stbi_failure_reason() << std::endl;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            texture& t = textures[handle];
+            t.decoded = nowNanoseconds();
+            if (image == nullptr) {
+                t.state = file.empty() ? textureMissing : textureFailed;
+                pending--;
+                continue;
+            }
+            t.pixels.swap(pixels);
+            t.levels.swap(levels);
+            t.state = textureDecoded;
+            uploadQueue.push_back(handle);
+        }
+    }
+
+    // immutable storage for every level up front, so nothing is reallocated as the slices arrive
+    void createStorage(texture& t) {
+        glGenTextures(1, &t.name);
+        glBindTexture(GL_TEXTURE_2D, t.name);
+        glTexStorage2D(GL_TEXTURE_2D, static_cast<GLsizei>(t.levels.size()), GL_RGBA8, t.levels[0].width, t.levels[0].height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        t.uploadLevel = static_cast<int>(t.levels.size()) - 1; // smallest first, they're nearly free
+        t.uploadRow = 0;
+    }
+
+    // copies the next band of rows into the unpack buffer and from there into the texture. True when it was the last.
+    bool uploadSlice(texture& t) {
+        const mipLevel& level = t.levels[t.uploadLevel];
+        size_t rowBytes = static_cast<size_t>(level.width) * 4;
+        int rows = static_cast<int>(sliceBytes / rowBytes);
+        if (rows < 1)
+            rows = 1;
+        if (rows > level.height - t.uploadRow)
+            rows = level.height - t.uploadRow;
+        size_t bytes = rowBytes * rows;
+
+        // orphaning gives a fresh buffer each slice, so the copy never waits on the previous one still in flight
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, unpackBuffer);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, static_cast<GLsizeiptr>(bytes), nullptr, GL_STREAM_DRAW);
+        void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(bytes), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (mapped != nullptr) {
+            memcpy(mapped, &t.pixels[level.offset + rowBytes * t.uploadRow], bytes);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        glBindTexture(GL_TEXTURE_2D, t.name);
+        glTexSubImage2D(GL_TEXTURE_2D, t.uploadLevel, 0, t.uploadRow, level.width, rows, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+        t.uploadRow += rows;
+        if (t.uploadRow < level.height)
+            return false;
+        t.uploadRow = 0;
+        return t.uploadLevel-- == 0;
+    }
+
+    void finish(texture& t) {
+        std::cout << "Texture " << t.path << " " << t.levels[0].width << "x" << t.levels[0].height << ", " << t.levels.size()
+            << " levels: decoded in " << (t.decoded - t.requested) / 1.0e6 << " ms, uploaded over " << t.uploadFrames << " frames" << std::endl;
+        std::vector<unsigned char>().swap(t.pixels);
+        t.ready = t.name;
+        std::lock_guard<std::mutex> lock(mutex);
+        t.state = textureReady;
+        pending--;
+    }
+};
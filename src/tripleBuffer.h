@@ -0,0 +1,32 @@
+#pragma once
+#include <atomic>
+
+// Lock-free single producer / single consumer mailbox that always holds the latest value. The writer fills
+// writeBuffer() and publish()es it, the reader gets the newest published value from read(). Neither side ever
+// waits: there are three buffers, one each for writer and reader and a spare that they swap through.
+template <typename T>
+class tripleBuffer {
+public:
+    static const int freshBit = 4; // set on 'spare' when it holds something the reader hasn't seen
+
+    T buffers[3];
+    int writeIndex = 0; // writer thread only
+    int readIndex = 1;  // reader thread only
+    std::atomic<int> spare{ 2 };
+
+    T& writeBuffer() {
+        return buffers[writeIndex];
+    }
+
+    // writer thread. The buffer handed back may hold an old value, so fill in every field before publishing.
+    void publish() {
+        writeIndex = spare.exchange(writeIndex | freshBit, std::memory_order_acq_rel) & ~freshBit;
+    }
+
+    // reader thread. Returns the same value again if nothing new was published.
+    const T& read() {
+        if (spare.load(std::memory_order_relaxed) & freshBit)
+            readIndex = spare.exchange(readIndex, std::memory_order_acq_rel) & ~freshBit;
+        return buffers[readIndex];
+    }
+};
@@ -0,0 +1,171 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <glad/glad.h>
+#include "gameClock.h"
+#include "hdrHistogram.h"
+#include "pixelReadback.h"
+#include "yuvConvert.h"
+
+// Records gameplay to a raw .y4m video (--capture=run.y4m). Each video frame the backbuffer is copied into a
+// pixelReadback ring, and once its fence has signalled an encoder thread converts it to YUV 4:2:0 straight
+// out of the mapped buffer and appends it to the file. The game thread only issues the copy and checks
+// fences; what that costs per frame is recorded and printed at the end.
+class videoCapture {
+public:
+    struct job {
+        int slot;
+        const uint8_t* pixels;
+        int repeat; // how many video frames this picture covers
+    };
+
+    bool enabled = false;
+    std::string path;
+    int width = 0;
+    int height = 0;
+    int fps = 60;
+    uint64_t frameInterval = 0;  // nanoseconds per video frame
+    uint64_t nextFrameTime = 0;
+    uint64_t framesCaptured = 0;
+    int repeats[pixelReadback::maxSlots] = {};
+
+    pixelReadback readback;
+    hdrHistogram gameThreadCost;
+
+    FILE* file = nullptr;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<job> jobs;
+    bool stopping = false;
+
+    std::vector<uint8_t> yuv;
+    uint64_t framesWritten = 0;
+    bool writeFailed = false;
+
+    // width and height are the backbuffer size; 4:2:0 needs them even so an odd last row/column is dropped
+    bool init(const std::string& path, int width, int height, int fps) {
+        if (path.empty())
+            return true;
+
+        this->path = path;
+        this->width = width & ~1;
+        this->height = height & ~1;
+        this->fps = fps > 0 ? fps : 60;
+        frameInterval = 1000000000ull / this->fps;
+
+        if (!readback.init(this->width, this->height, 4)) {
+            std::cout << "Video capture needs OpenGL 4.4 (persistent mapped buffers)" << std::endl;
+            return false;
+        }
+        file = fopen(path.c_str(), "wb");
+        if (file == nullptr) {
+            std::cout << "Couldn't open " << path << " for video capture" << std::endl;
+            readback.shutdown();
+            return false;
+        }
+        // C420jpeg = full range, chroma centred between the pixels, which is what yuvConvert produces
+        fprintf(file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", this->width, this->height, this->fps);
+        yuv.resize(static_cast<size_t>(this->width) * this->height * 3 / 2);
+
+        stopping = false;
+        worker = std::thread([this] { run(); });
+        nextFrameTime = 0;
+        enabled = true;
+        return true;
+    }
+
+    // game thread, after the frame is drawn and before the swap. framebuffer 0 and GL_BACK for the window.
+    void captureFrame(GLuint framebuffer, GLenum readBuffer) {
+        if (!enabled)
+            return;
+
+        uint64_t start = nowNanoseconds();
+        auto toEncoder = [this](int slot, const uint8_t* pixels, int, int, uint64_t) {
+            push(slot, pixels);
+        };
+
+        // the video runs at a fixed rate: skip frames that come early, repeat ones that had to cover a hitch
+        if (nextFrameTime == 0)
+            nextFrameTime = start;
+        if (start >= nextFrameTime) {
+            int repeat = static_cast<int>((start - nextFrameTime) / frameInterval) + 1;
+            nextFrameTime += frameInterval * repeat;
+            repeats[readback.next] = repeat;
+            readback.capture(framebuffer, readBuffer, framesCaptured++, toEncoder);
+        }
+        readback.poll(toEncoder);
+
+        gameThreadCost.record(nowNanoseconds() - start);
+    }
+
+    void push(int slot, const uint8_t* pixels) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back({ slot, pixels, repeats[slot] });
+        }
+        wake.notify_one();
+    }
+
+    void run() {
+        size_t lumaSize = static_cast<size_t>(width) * height;
+        while (true) {
+            job next;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+                if (jobs.empty())
+                    return;
+                next = jobs.front();
+                jobs.pop_front();
+            }
+
+            rgbaToYuv420(next.pixels, width, height, yuv.data(), yuv.data() + lumaSize, yuv.data() + lumaSize * 5 / 4);
+            readback.release(next.slot);
+
+            for (int i = 0; i < next.repeat && !writeFailed; i++) {
+                fputs("FRAME\n", file);
+                if (fwrite(yuv.data(), 1, yuv.size(), file) != yuv.size())
+                    writeFailed = true;
+                else
+                    framesWritten++;
+            }
+        }
+    }
+
+    // game thread, with the GL context still current
+    void shutdown() {
+        if (!enabled)
+            return;
+
+        readback.finish([this](int slot, const uint8_t* pixels, int, int, uint64_t) { push(slot, pixels); });
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+        readback.shutdown();
+        fclose(file);
+        file = nullptr;
+        enabled = false;
+
+        std::cout << std::fixed << std::setprecision(3)
+            << "Captured " << framesWritten << " video frames (" << width << "x" << height << " @ " << fps
+            << " fps) to " << path << std::endl
+            << "  game thread cost per frame: median " << gameThreadCost.percentile(50.0) / 1e6
+            << " ms, p99 " << gameThreadCost.percentile(99.0) / 1e6
+            << " ms, max " << gameThreadCost.maxValue / 1e6 << " ms, " << readback.stalls
+            << " waits on the encoder" << std::endl;
+        if (writeFailed)
+            std::cout << "  the disk couldn't keep up or filled, the video is cut short" << std::endl;
+    }
+};
@@ -0,0 +1,127 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define YUV_HAS_SSSE3 1
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#define YUV_HAS_SSSE3 1
+#endif
+
+// RGBA to planar YUV 4:2:0 (full range BT.601, what Y4M's C420jpeg means) for video capture.
+// Coefficients are 7 bit so the SSSE3 path can do a whole pixel with one maddubs + hadd; the scalar path
+// uses the same maths so both give identical bytes. Chroma is taken from the average of each 2x2 block.
+//
+//   Y =  38 R + 75 G + 15 B            (/128)
+//   U = -22 R - 42 G + 64 B    + 128
+//   V =  64 R - 54 G - 10 B    + 128
+
+inline uint8_t yuvClamp(int value) {
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// two source rows (top and bottom of the pair) to two Y rows and one U and V row, from pixel x on
+inline void rgbaToYuv420RowsScalar(const uint8_t* top, const uint8_t* bottom, int x, int width,
+    uint8_t* yTop, uint8_t* yBottom, uint8_t* u, uint8_t* v) {
+    for (; x < width; x += 2) {
+        int uSum = 0, vSum = 0;
+        for (int i = 0; i < 2; i++) {
+            const uint8_t* a = top + (x + i) * 4;
+            const uint8_t* b = bottom + (x + i) * 4;
+            yTop[x + i] = yuvClamp((38 * a[0] + 75 * a[1] + 15 * a[2] + 64) >> 7);
+            yBottom[x + i] = yuvClamp((38 * b[0] + 75 * b[1] + 15 * b[2] + 64) >> 7);
+
+            int r = (a[0] + b[0] + 1) >> 1, g = (a[1] + b[1] + 1) >> 1, bl = (a[2] + b[2] + 1) >> 1;
+            uSum += -22 * r - 42 * g + 64 * bl;
+            vSum += 64 * r - 54 * g - 10 * bl;
+        }
+        // >> on a negative int is an arithmetic shift on every compiler we build with, same as srai below
+        u[x / 2] = yuvClamp(((uSum + 128 > 32767 ? 32767 : uSum + 128) >> 8) + 128);
+        v[x / 2] = yuvClamp(((vSum + 128 > 32767 ? 32767 : vSum + 128) >> 8) + 128);
+    }
+}
+
+#ifdef YUV_HAS_SSSE3
+// MSVC builds the SSSE3 path for every x86 target, so the CPU is asked (CPUID leaf 1, ECX bit 9) and one without
+// it gets the scalar path. Elsewhere the path only exists when the compiler was told the target has SSSE3.
+inline bool yuvCpuHasSsse3() {
+#ifdef _MSC_VER
+    static const bool hasSsse3 = [] {
+        int info[4];
+        __cpuid(info, 1);
+        return (info[2] & (1 << 9)) != 0;
+    }();
+    return hasSsse3;
+#else
+    return true;
+#endif
+}
+
+inline void rgbaToYuv420RowsSsse3(const uint8_t* top, const uint8_t* bottom, int width,
+    uint8_t* yTop, uint8_t* yBottom, uint8_t* u, uint8_t* v) {
+    const __m128i yCoefficients = _mm_setr_epi8(38, 75, 15, 0, 38, 75, 15, 0, 38, 75, 15, 0, 38, 75, 15, 0);
+    const __m128i uCoefficients = _mm_setr_epi8(-22, -42, 64, 0, -22, -42, 64, 0, -22, -42, 64, 0, -22, -42, 64, 0);
+    const __m128i vCoefficients = _mm_setr_epi8(64, -54, -10, 0, 64, -54, -10, 0, 64, -54, -10, 0, 64, -54, -10, 0);
+    const __m128i yRound = _mm_set1_epi16(64);
+    const __m128i chromaRound = _mm_set1_epi16(128);
+    const __m128i chromaOffset = _mm_set1_epi16(128);
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m128i topA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + x * 4));
+        __m128i topB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + x * 4 + 16));
+        __m128i bottomA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + x * 4));
+        __m128i bottomB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + x * 4 + 16));
+
+        // luma: (R,G) and (B,A) pairs multiplied and summed, then the two halves of each pixel added
+        __m128i yTop16 = _mm_hadd_epi16(_mm_maddubs_epi16(topA, yCoefficients), _mm_maddubs_epi16(topB, yCoefficients));
+        __m128i yBottom16 = _mm_hadd_epi16(_mm_maddubs_epi16(bottomA, yCoefficients), _mm_maddubs_epi16(bottomB, yCoefficients));
+        yTop16 = _mm_srli_epi16(_mm_add_epi16(yTop16, yRound), 7);
+        yBottom16 = _mm_srli_epi16(_mm_add_epi16(yBottom16, yRound), 7);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(yTop + x), _mm_packus_epi16(yTop16, yTop16));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(yBottom + x), _mm_packus_epi16(yBottom16, yBottom16));
+
+        // chroma: average the rows, per pixel values, then sum horizontal pairs
+        __m128i averageA = _mm_avg_epu8(topA, bottomA);
+        __m128i averageB = _mm_avg_epu8(topB, bottomB);
+        __m128i u16 = _mm_hadd_epi16(_mm_maddubs_epi16(averageA, uCoefficients), _mm_maddubs_epi16(averageB, uCoefficients));
+        __m128i v16 = _mm_hadd_epi16(_mm_maddubs_epi16(averageA, vCoefficients), _mm_maddubs_epi16(averageB, vCoefficients));
+        __m128i uv = _mm_hadd_epi16(u16, v16); // 4 U pair sums then 4 V pair sums
+        uv = _mm_add_epi16(_mm_srai_epi16(_mm_adds_epi16(uv, chromaRound), 8), chromaOffset);
+        __m128i packed = _mm_packus_epi16(uv, uv);
+
+        int uBytes = _mm_cvtsi128_si32(packed);
+        int vBytes = _mm_cvtsi128_si32(_mm_srli_si128(packed, 4));
+        for (int i = 0; i < 4; i++) {
+            u[x / 2 + i] = static_cast<uint8_t>(uBytes >> (8 * i));
+            v[x / 2 + i] = static_cast<uint8_t>(vBytes >> (8 * i));
+        }
+    }
+    rgbaToYuv420RowsScalar(top, bottom, x, width, yTop, yBottom, u, v);
+}
+#endif
+
+// rgba is bottom-up (straight from glReadPixels), the planes come out top row first. width and height must be even.
+inline void rgbaToYuv420(const uint8_t* rgba, int width, int height, uint8_t* yPlane, uint8_t* uPlane, uint8_t* vPlane) {
+    size_t stride = static_cast<size_t>(width) * 4;
+#ifdef YUV_HAS_SSSE3
+    bool useSsse3 = yuvCpuHasSsse3();
+#endif
+    for (int row = 0; row < height; row += 2) {
+        const uint8_t* top = rgba + stride * (height - 1 - row);
+        const uint8_t* bottom = rgba + stride * (height - 2 - row);
+        uint8_t* yTop = yPlane + static_cast<size_t>(width) * row;
+        uint8_t* yBottom = yTop + width;
+        uint8_t* u = uPlane + static_cast<size_t>(width / 2) * (row / 2);
+        uint8_t* v = vPlane + static_cast<size_t>(width / 2) * (row / 2);
+#ifdef YUV_HAS_SSSE3
+        if (useSsse3) {
+            rgbaToYuv420RowsSsse3(top, bottom, width, yTop, yBottom, u, v);
+            continue;
+        }
+#endif
+        rgbaToYuv420RowsScalar(top, bottom, 0, width, yTop, yBottom, u, v);
+    }
+}
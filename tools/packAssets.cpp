@@ -0,0 +1,171 @@
+// pack_assets: builds assets.pak, the single memory-mapped file the game loads its font and sounds from.
+//
+//     pack_assets                                  the game's own assets into assets.pak, run from the repo root
+//     pack_assets --out=assets.pak fonts/a.ttf sounds/b.wav
+//     pack_assets --sample-rate=44100 --channels=2
+//
+// .wav files are decoded and converted to float PCM at the given rate and channel count (48 kHz stereo by default,
+// what most output devices run at, so the engine rarely has to resample). Everything else is stored as it is.
+// Entries are named by their path as given, with forward slashes and without a leading "./".
+#define MA_NO_DEVICE_IO
+#define MA_NO_ENGINE
+#define MA_NO_NODE_GRAPH
+#define MA_NO_RESOURCE_MANAGER
+#define MINIAUDIO_IMPLEMENTATION
+#include "miniaudio.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "../src/assetPack.h"
+
+struct packInput {
+    std::string path;
+    std::string name;
+    assetPackEntry entry = {};
+    std::vector<unsigned char> bytes;
+};
+
+static std::string entryName(std::string path) {
+    for (char& c : path)
+        if (c == '\\')
+            c = '/';
+    while (path.compare(0, 2, "./") == 0)
+        path.erase(0, 2);
+    return path;
+}
+
+static bool endsWith(const std::string& text, const char* suffix) {
+    size_t length = strlen(suffix);
+    return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+static bool readFile(const std::string& path, std::vector<unsigned char>& bytes) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static bool decodeSound(packInput& input, ma_uint32 channels, ma_uint32 sampleRate) {
+    ma_decoder_config config = ma_decoder_config_init(ma_format_f32, channels, sampleRate);
+    ma_uint64 frameCount = 0;
+    void* frames = nullptr;
+    if (ma_decode_file(input.path.c_str(), &config, &frameCount, &frames) != MA_SUCCESS)
+        return false;
+
+    size_t size = static_cast<size_t>(frameCount) * channels * sizeof(float);
+    input.bytes.assign(static_cast<unsigned char*>(frames), static_cast<unsigned char*>(frames) + size);
+    ma_free(frames, NULL);
+
+    input.entry.type = assetPcmF32;
+    input.entry.channels = channels;
+    input.entry.sampleRate = sampleRate;
+    input.entry.frameCount = static_cast<uint32_t>(frameCount);
+    return true;
+}
+
+static uint64_t alignUp(uint64_t value) {
+    return (value + assetPackHeader::alignment - 1) / assetPackHeader::alignment * assetPackHeader::alignment;
+}
+
+int main(int argc, char** argv) {
+    std::string outPath = "assets.pak";
+    ma_uint32 sampleRate = 48000;
+    ma_uint32 channels = 2;
+    std::vector<packInput> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 6, "--out=") == 0)
+            outPath = arg.substr(6);
+        else if (arg.compare(0, 14, "--sample-rate=") == 0)
+            sampleRate = static_cast<ma_uint32>(std::atoi(arg.c_str() + 14));
+        else if (arg.compare(0, 11, "--channels=") == 0)
+            channels = static_cast<ma_uint32>(std::atoi(arg.c_str() + 11));
+        else if (arg.compare(0, 2, "--") == 0) {
+            std::cout << "Unknown option: " << arg << std::endl;
+            return 1;
+        }
+        else {
+            packInput input;
+            input.path = arg;
+            inputs.push_back(input);
+        }
+    }
+    if (sampleRate == 0 || channels == 0 || channels > 2) {
+        std::cout << "Need a sample rate and 1 or 2 channels" << std::endl;
+        return 1;
+    }
+
+    if (inputs.empty()) {
+        const char* gameAssets[] = { "fonts/VCR_OSD_MONO_1.001.ttf", "sounds/dink.wav", "sounds/getPoint.wav", "sounds/countdown.wav", "sounds/win.wav" };
+        for (const char* path : gameAssets) {
+            packInput input;
+            input.path = path;
+            inputs.push_back(input);
+        }
+    }
+
+    for (packInput& input : inputs) {
+        input.name = entryName(input.path);
+        if (input.name.size() >= assetPackEntry::maxName) {
+            std::cout << input.name << ": names are limited to " << assetPackEntry::maxName - 1 << " characters" << std::endl;
+            return 1;
+        }
+        bool loaded = endsWith(input.name, ".wav") ? decodeSound(input, channels, sampleRate) : readFile(input.path, input.bytes);
+        if (!loaded) {
+            std::cout << "Couldn't load " << input.path << std::endl;
+            return 1;
+        }
+        memcpy(input.entry.name, input.name.c_str(), input.name.size() + 1);
+        input.entry.size = input.bytes.size();
+    }
+
+    assetPackHeader header = {};
+    header.magic = assetPackHeader::packMagic;
+    header.version = assetPackHeader::packVersion;
+    header.entryCount = static_cast<uint32_t>(inputs.size());
+    header.indexOffset = sizeof(assetPackHeader);
+
+    uint64_t offset = alignUp(header.indexOffset + sizeof(assetPackEntry) * inputs.size());
+    for (packInput& input : inputs) {
+        input.entry.offset = offset;
+        offset = alignUp(offset + input.entry.size);
+    }
+    header.fileSize = offset;
+
+    std::ofstream file(outPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cout << "Couldn't write " << outPath << std::endl;
+        return 1;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const packInput& input : inputs)
+        file.write(reinterpret_cast<const char*>(&input.entry), sizeof(input.entry));
+
+    const char padding[assetPackHeader::alignment] = {};
+    uint64_t written = sizeof(header) + sizeof(assetPackEntry) * inputs.size();
+    for (const packInput& input : inputs) {
+        file.write(padding, static_cast<std::streamsize>(input.entry.offset - written));
+        file.write(reinterpret_cast<const char*>(input.bytes.data()), static_cast<std::streamsize>(input.bytes.size()));
+        written = input.entry.offset + input.entry.size;
+    }
+    file.write(padding, static_cast<std::streamsize>(header.fileSize - written));
+    if (!file) {
+        std::cout << "Couldn't write " << outPath << std::endl;
+        return 1;
+    }
+
+    for (const packInput& input : inputs) {
+        std::cout << "  " << input.name << "  " << input.entry.size << " bytes";
+        if (input.entry.type == assetPcmF32)
+            std::cout << ", " << input.entry.frameCount << " frames of " << input.entry.channels << "ch " << input.entry.sampleRate << " Hz float";
+        std::cout << std::endl;
+    }
+    std::cout << "Wrote " << outPath << ", " << header.fileSize << " bytes" << std::endl;
+    return 0;
+}